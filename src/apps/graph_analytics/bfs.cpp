@@ -24,6 +24,7 @@ void run(std::string filepath, vid_t nvertices, vid_t root)
 
   vp.display();
   timer.report();
+  Memory::report();
 
   long nreachable = vp.reduce<long>(
       [&](uint32_t vid, const BfsState& s) -> long { return s.hops != INF; },  // mapper
@@ -8,12 +8,14 @@
 /* Identify the connected components in an undirected graph. */
 
 
-void run(std::string filepath, vid_t nvertices)
+void run(std::string filepath, vid_t nvertices, ExecutionMode mode)
 {
   Graph<ew_t> G;
   G.load_undirected(true, filepath, nvertices);
 
   CcVertex vp(&G);
+  vp.persistent = true;  // Same exchange pattern every iteration.
+  vp.mode = mode;  // Labels only decrease: stale messages are harmless.
   vp.initialize();
 
   Env::barrier();
@@ -23,6 +25,7 @@ void run(std::string filepath, vid_t nvertices)
 
   vp.display();
   timer.report();
+  Memory::report();
 
   long checksum = vp.reduce<long>(
       [&](uint32_t idx, const CcState& s) -> long { return s.label; },  // mapper
@@ -38,15 +41,17 @@ int main(int argc, char* argv[])
   /* Print usage. */
   if (argc < 3)
   {
-    LOG.info("Usage: %s <filepath> <num_vertices: 0 if header present> \n", argv[0]);
+    LOG.info("Usage: %s <filepath> <num_vertices: 0 if header present> "
+                 "[<mode>: bsp (default) | async] \n", argv[0]);
     Env::exit(1);
   }
 
   /* Read input arguments. */
   std::string filepath = argv[1];
   vid_t nvertices = (vid_t) std::atol(argv[2]);
+  ExecutionMode mode = (argc > 3) ? ExecutionMode(argv[3]) : ExecutionMode(ExecutionMode::BSP);
 
-  run(filepath, nvertices);
+  run(filepath, nvertices, mode);
 
   Env::finalize();
   return 0;
@@ -43,6 +43,7 @@ void run(std::string filepath, vid_t nvertices, bool out_degree = false)
     LOG.info("idx %u: degree %u \n", iv.first, iv.second);
 
   timer.report();
+  Memory::report();
 }
 
 
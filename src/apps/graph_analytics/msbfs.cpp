@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include "utils/dist_timer.h"
+#include "msbfs.h"
+
+
+/* Perform undirected BFS on a graph from several root vertices at once (multi-source). */
+
+
+void run(std::string filepath, vid_t nvertices, const std::vector<vid_t>& roots)
+{
+  Graph<ew_t> G;
+  G.load_undirected(true, filepath, nvertices);
+
+  MsBfsVertex vp(&G);
+  vp.roots = roots;
+  vp.initialize();
+
+  Env::barrier();
+  DistTimer timer("Multi-Source BFS Execution");
+  vp.execute();  // until convergence (of all lanes)
+  timer.stop();
+
+  timer.report();
+  Memory::report();
+
+  for (uint32_t b = 0; b < roots.size(); b++)
+  {
+    long nreachable = vp.reduce<long>(
+        [&](uint32_t vid, const MsBfsVertex::LaneState& s) -> long { return s[b].hops != INF; },
+        [&](long& a, const long& b) { a += b; });  // reducer
+    long checksum = vp.reduce<long>(
+        [&](uint32_t vid, const MsBfsVertex::LaneState& s) -> long
+        { return s[b].hops * s[b].parent; },
+        [&](long& a, const long& b) { a += b; });  // reducer
+    LOG.info("Root %u: Reachable Vertices = %lu, Checksum = %lu \n", roots[b], nreachable,
+             checksum);
+  }
+}
+
+
+int main(int argc, char* argv[])
+{
+  Env::init();
+
+  /* Print usage. */
+  if (argc < 4)
+  {
+    LOG.info("Usage: %s <filepath> <num_vertices: 0 if header present> <root> [<root> ...] "
+             "(at most %u roots) \n", argv[0], BATCH_SIZE);
+    Env::exit(1);
+  }
+
+  /* Read input arguments. */
+  std::string filepath = argv[1];
+  vid_t nvertices = (vid_t) std::atol(argv[2]);
+
+  std::vector<vid_t> roots;
+  for (int i = 3; i < argc and roots.size() < BATCH_SIZE; i++)
+    roots.push_back((vid_t) std::atol(argv[i]));
+
+  if (argc - 3 > (int) BATCH_SIZE)
+    LOG.warn("Only the first %u roots are used. \n", BATCH_SIZE);
+
+  run(filepath, nvertices, roots);
+
+  Env::finalize();
+  return 0;
+}
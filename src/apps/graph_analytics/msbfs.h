@@ -0,0 +1,44 @@
+#ifndef MSBFS_H
+#define MSBFS_H
+
+#include <cassert>
+#include <vector>
+#include "vprogram/batch_vertex_program.h"
+#include "bfs.h"
+
+
+/* Perform BFS on an undirected graph from up to BATCH_SIZE roots at once (one per lane). */
+
+
+constexpr uint32_t BATCH_SIZE = 16;
+
+
+class MsBfsVertex : public BatchVertexProgram<ew_t, Empty, vid_t, BfsState, BATCH_SIZE>
+{
+public:
+  using W = ew_t; using M = Empty; using A = vid_t; using S = BfsState;
+  using BatchVertexProgram<W, M, A, S, BATCH_SIZE>::BatchVertexProgram;  // inherit constructors
+
+  std::vector<vid_t> roots;  // one per lane
+
+  bool init(uint32_t vid, BfsState& s, uint32_t lane)
+  {
+    if (lane < roots.size() and vid == roots[lane]) { s.hops = 0; return true; }
+    return false;
+  }
+
+  M scatter(const BfsState& s) { return M(); }
+  A gather(const Edge<W>& edge, const M& msg) { return edge.src; }  // parent's id
+  void combine(const A& y1, A& y2) { y2 = y1; }  // just use the last parent's id
+  bool apply(const A& y, BfsState& s, uint32_t iter)
+  {
+    if (s.hops != INF)
+      return false;  // already visited
+    s.hops = (dist_t) (iter + 1);
+    s.parent = y;
+    return true;
+  }
+};
+
+
+#endif
@@ -8,7 +8,8 @@
 /* Calculate Pagerank for a directed input graph. */
 
 
-void run(std::string filepath, vid_t nvertices, uint32_t niters)
+void run(std::string filepath, vid_t nvertices, uint32_t niters, ValueCodec codec,
+         ExecutionMode mode)
 {
   /* Calculate out-degrees */
   Graph<ew_t> GR; // reverse graph for out-degree
@@ -29,6 +30,8 @@ void run(std::string filepath, vid_t nvertices, uint32_t niters)
 
   /* Pagerank initialization using out-degrees */
   PrVertex vp(&G, true);  // stationary
+  vp.message_codec = codec;  // Lossy (16-bit) messages, if requested.
+  vp.mode = mode;  // Overlapped iterations, if requested.
 
   vp.initialize(vp_degree);
   //vp.display();
@@ -42,6 +45,7 @@ void run(std::string filepath, vid_t nvertices, uint32_t niters)
   vp.display();
   degree_timer.report();
   pr_timer.report();
+  Memory::report();
 
   long deg_checksum = vp.reduce<long>(
       [&](uint32_t idx, const PrState& s) -> long { return s.degree; },  // mapper
@@ -63,7 +67,9 @@ int main(int argc, char* argv[])
   if (argc < 3)
   {
     LOG.info("Usage: %s <filepath> <num_vertices: 0 if header present> "
-                 "[<iterations> (default: until convergence)] \n", argv[0]);
+                 "[<iterations> (default: until convergence)] "
+                 "[<message codec>: none (default) | float16 | bfloat16] "
+                 "[<mode>: bsp (default) | pipelined] \n", argv[0]);
     Env::exit(1);
   }
 
@@ -71,8 +77,10 @@ int main(int argc, char* argv[])
   std::string filepath = argv[1];
   vid_t nvertices = (vid_t) std::atol(argv[2]);
   uint32_t niters = (argc > 3) ? (uint32_t) atoi(argv[3]) : 0;
+  ValueCodec codec = (argc > 4) ? ValueCodec(argv[4]) : ValueCodec(ValueCodec::NONE);
+  ExecutionMode mode = (argc > 5) ? ExecutionMode(argv[5]) : ExecutionMode(ExecutionMode::BSP);
 
-  run(filepath, nvertices, niters);
+  run(filepath, nvertices, niters, codec, mode);
 
   Env::finalize();
   return 0;
@@ -24,6 +24,8 @@ struct PrState : DegState
   { return "{rank: " + std::to_string(rank) + ", degree: " + std::to_string(degree) + "}"; }
 };
 
+SOA_STATE(PrState, (rank)(degree))  // Stored as a struct of arrays (see StateLayout).
+
 
 class PrVertex : public VertexProgram<ew_t, fp_t, fp_t, PrState>  // <W, M, A, S>
 {
@@ -31,13 +33,13 @@ public:
   using W = ew_t; using M = fp_t; using A = fp_t; using S = PrState;
   using VertexProgram<W, M, A, S>::VertexProgram;  // inherit constructors
 
-  bool init(uint32_t vid, const State& other, PrState& s)
+  bool init(uint32_t vid, const State& other, StateRef s)
   { s.degree = ((const DegState&) other).degree; return true; }
 
-  M scatter(const PrState& s) { return s.rank / s.degree; }
+  M scatter(ConstStateRef s) { return s.rank / s.degree; }
   A gather(const Edge<W>& edge, const M& msg) { return msg; }
   void combine(const A& y1, A& y2) { y2 += y1; }
-  bool apply(const A& y, PrState& s)
+  bool apply(const A& y, StateRef s)
   {
     A tmp = s.rank;
     s.rank = alpha + (1.0 - alpha) * y;
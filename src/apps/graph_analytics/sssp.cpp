@@ -8,13 +8,16 @@
 /* Find shortest paths from a given root vertex to all vertices of a weighted directed graph. */
 
 
-void run(std::string filepath, vid_t nvertices, vid_t root)
+void run(std::string filepath, vid_t nvertices, vid_t root, ExecutionMode mode, uint32_t delta)
 {
   Graph<ew_t> G;
   G.load_directed(true, filepath, nvertices);
 
   SpVertex vp(&G);
   vp.root = root;
+  vp.persistent = true;  // Same exchange pattern every iteration.
+  vp.mode = mode;  // Distances only decrease: stale messages are harmless.
+  vp.delta = delta;  // Buckets of distance width delta (BSP only).
   vp.initialize();
 
   Env::barrier();
@@ -24,6 +27,7 @@ void run(std::string filepath, vid_t nvertices, vid_t root)
 
   vp.display();
   timer.report();
+  Memory::report();
 
   long nreachable = vp.reduce<long>(
       [&](uint32_t vid, const SpState& s) -> long { return s.distance != INF; },  // mapper
@@ -44,7 +48,9 @@ int main(int argc, char* argv[])
   /* Print usage. */
   if (argc < 4)
   {
-    LOG.info("Usage: %s <filepath> <num_vertices: 0 if header present> <root> \n", argv[0]);
+    LOG.info("Usage: %s <filepath> <num_vertices: 0 if header present> <root> "
+                 "[<mode>: bsp (default) | async | pipelined] "
+                 "[<delta>: 0 (default: no buckets)] \n", argv[0]);
     Env::exit(1);
   }
 
@@ -52,8 +58,10 @@ int main(int argc, char* argv[])
   std::string filepath = argv[1];
   vid_t nvertices = (vid_t) std::atol(argv[2]);
   vid_t root = (vid_t) std::atol(argv[3]);
+  ExecutionMode mode = (argc > 4) ? ExecutionMode(argv[4]) : ExecutionMode(ExecutionMode::BSP);
+  uint32_t delta = (argc > 5) ? (uint32_t) atoi(argv[5]) : 0;
 
-  run(filepath, nvertices, root);
+  run(filepath, nvertices, root, mode, delta);
 
   Env::finalize();
   return 0;
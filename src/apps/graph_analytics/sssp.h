@@ -43,6 +43,7 @@ public:
     s.distance = std::min(s.distance, y);
     return tmp != s.distance;
   }
+  uint32_t priority(const SpState& s) { return s.distance.value; }  // (for delta-stepping)
 };
 
 
@@ -44,6 +44,7 @@ void run(std::string filepath, vid_t nvertices)
   gn_timer.report();
   ct_timer.report();
   tc_timer.report();
+  Memory::report();
 
   long ntriangles = vp_ct.reduce<long>(
       [&](uint32_t idx, const CtState& s) -> long { return s.ntriangles; },  // mapper
@@ -44,10 +44,10 @@ struct CtState : State, SerializableVector<vid_t>
 };
 
 
-class GnVertex : public VertexProgram<ew_t, Empty, SerializableVector<vid_t>, GnState>
+class GnVertex : public VertexProgram<ew_t, Empty, ArenaVector<vid_t>, GnState>
 {
 public:
-  using W = ew_t; using M = Empty; using A = SerializableVector<vid_t>; using S = GnState;
+  using W = ew_t; using M = Empty; using A = ArenaVector<vid_t>; using S = GnState;
   using VertexProgram<W, M, A, S>::VertexProgram;  // inherit constructors
 
   M scatter(const GnState& s) { return M(); }
@@ -57,7 +57,7 @@ public:
   {
     if (not y.empty())
     {
-      s.neighbors = std::move(y);
+      s.neighbors.assign(y.cbegin(), y.cend());
       std::sort(s.neighbors.begin(), s.neighbors.end());
     }
     return false;  // No need to scatter.
@@ -65,10 +65,10 @@ public:
 };
 
 
-class CtVertex : public VertexProgram<ew_t, SerializableVector<vid_t>, uint32_t, CtState>
+class CtVertex : public VertexProgram<ew_t, ArenaVector<vid_t>, uint32_t, CtState>
 {
 public:
-  using W = ew_t; using M = SerializableVector<vid_t>; using A = uint32_t; using S = CtState;
+  using W = ew_t; using M = ArenaVector<vid_t>; using A = uint32_t; using S = CtState;
   using VertexProgram<W, M, A, S>::VertexProgram;  // inherit constructors
 
   bool init(uint32_t vid, const State& other, CtState& s)
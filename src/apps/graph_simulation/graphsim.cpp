@@ -82,6 +82,7 @@ void run(string& dgl_filepath, string& dgm_filepath, vid_t nvertices,
 
   init_timer.report();
   gs_timer.report();
+  Memory::report();
 }
 
 
@@ -87,8 +87,8 @@ public:
 
 
 using W = ew_t;
-using M = svector_bool;  // temp mismatches vector
-using A = svector_int;   // actual mismatches vector
+using M = ArenaVector<bool>;  // temp mismatches vector
+using A = ArenaVector<int>;   // actual mismatches vector
 using S = GsState;
 
 class GsVertex : public VertexProgram<W, M, A, S>
@@ -26,6 +26,8 @@ struct DtState : State
   { return "length: " + std::to_string(length) + ", score: " + std::to_string(score); }
 };
 
+SOA_STATE(DtState, (length)(score))  // Stored as a struct of arrays (see StateLayout).
+
 
 /* idf(t) = log10((nd - in-degree(t) + 0.5) / (in-degree(t) + 0.5)) */
 class IDF : public VertexProgram<ew_t, Empty, fp_t, DtState>  // <Weight, Msg, Accum, State>
@@ -34,10 +36,10 @@ public:
   using W = ew_t; using M = Empty; using A = fp_t; using S = DtState;
   using VertexProgram<W, M, A, S>::VertexProgram;  // inherit constructors
 
-  M scatter(const DtState& s) { return M(); }  // doc -> msg(empty) -> term
+  M scatter(ConstStateRef s) { return M(); }  // doc -> msg(empty) -> term
   A gather(const Edge<W>& edge, const M& msg) { return 1.0; }
   void combine(const A& y1, A& y2) { y2 += y1; }
-  bool apply(const A& y, DtState& s)
+  bool apply(const A& y, StateRef s)
   {
     vid_t ndocs = get_graph()->get_nvertices_left();
     s.length = log10((ndocs - y + 0.5) / (y + 0.5));  // length(t) is idf(t)
@@ -55,10 +57,10 @@ public:
 
   fp_t avg_doc_length = 0;
 
-  M scatter(const DtState& s) { return M(); }  // term -> msg(empty) -> doc
+  M scatter(ConstStateRef s) { return M(); }  // term -> msg(empty) -> doc
   A gather(const Edge<W>& edge, const M& msg) { return edge.weight; }
   void combine(const A& y1, A& y2) { y2 += y1; }
-  bool apply(const A& y, DtState& s)
+  bool apply(const A& y, StateRef s)
   {
     //fp_t avg_terms_per_doc = get_graph()->get_nedges() / (double) get_graph()->get_nvertices_left();
     //s.length = 1.5 * y / avg_terms_per_doc + 0.5;
@@ -78,17 +80,17 @@ public:
   using W = ew_t; using M = fp_t; using A = fp_t; using S = DtState;
   using VertexProgram<W, M, A, S>::VertexProgram;  // inherit constructors
 
-  bool init(vid_t vid, DtState& s) { return true; }
-  M scatter(const DtState& s) { return s.length; }  // term -> msg(idf) -> doc
+  bool init(vid_t vid, StateRef s) { return true; }
+  M scatter(ConstStateRef s) { return s.length; }  // term -> msg(idf) -> doc
   //A gather(const Edge<W>& edge, const M& msg) { return edge.weight * msg; }
-  A gather(const Edge<W>& edge, const M& msg, const DtState& s)
+  A gather(const Edge<W>& edge, const M& msg, ConstStateRef s)
   //{ return edge.weight / (edge.weight + s.length) * msg; }
   { fp_t tfidf = (edge.weight * (k1 + 1)) / (edge.weight + s.length) * msg;
     //LOG.info<false, false>("%u %u %u %f %f %f\n",
     //                       edge.src, edge.dst, edge.weight, s.length, msg, tfidf);
     return tfidf; }
   void combine(const A& y1, A& y2) { y2 += y1; }
-  bool apply(const A& y, DtState& s) { s.score = y; return true; }
+  bool apply(const A& y, StateRef s) { s.score = y; return true; }
 };
 
 
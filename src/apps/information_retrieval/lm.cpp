@@ -108,6 +108,7 @@ void run(string& filepath_graph, vid_t ndocs, vid_t nterms,
   LOG.info("Init time: %lf \n", init_time / queries.size());
   LOG.info("TFIDF time: %lf \n", tfidf_time / queries.size());
   LOG.info("Top-k time: %lf \n", topk_time / queries.size());
+  Memory::report();
 }
 
 
@@ -33,6 +33,21 @@ public:
 
   void distribute();
 
+private:
+  /* Automatic row bands hold at least this many nonzeros (see split_rowgrp()). */
+  static constexpr uint64_t BAND_MIN_NNZ = 1 << 14;
+
+  /**
+   * Split the rows of every local rowgroup into bands, of about as many nonzeros across its local
+   * tiles, at bitvector-word boundaries (see CSC::split()). Bands of the same yseg can then be
+   * processed by different threads, so that a few ranks (e.g., one per node) with many threads
+   * each are not limited to one thread per local rowgroup. Returns the bytes of band pointers.
+   **/
+  uint64_t split_rowgrps();
+
+  template <bool sink>
+  uint64_t split_rowgrp(typename Annotation::RowGrp& rowgrp, uint32_t nbands);
+
 public:
   /* Inherited from ProcessedMatrix2D. */
   using Base = ProcessedMatrix2D<Weight, Annotation>;
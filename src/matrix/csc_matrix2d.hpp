@@ -1,4 +1,7 @@
+#include <algorithm>
 #include <unordered_set>
+#include <vector>
+#include <omp.h>
 
 
 template <class Weight, class Annotation>
@@ -79,6 +82,12 @@ void CSCMatrix2D<Weight, Annotation>::distribute()
       tile->sink_csc = new CSC<Weight>(colgrp.local->count(), rowgrp.offset, colgrp.offset, sink,
                                        locator, *colgrp.locator, *rowgrp.global_locator);
 
+      if (OutOfCore::enabled())
+      {
+        tile->csc->spill();
+        tile->sink_csc->spill();
+      }
+
       delete regular;
       delete sink;
     }
@@ -86,4 +95,92 @@ void CSCMatrix2D<Weight, Annotation>::distribute()
 
   Env::barrier();
   LOG.info<true, false>("\n");
+
+  uint64_t nbytes = split_rowgrps();
+
+  uint32_t max_nbands = 0;
+  for (auto& rowgrp : local_rowgrps)
+    max_nbands = std::max(max_nbands, std::max(rowgrp.nbands, rowgrp.sink_nbands));
+
+  if (max_nbands > 1)
+    LOG.info("#> Split the local rowgroups into up to %u row bands (%lu KB of pointers).\n",
+             max_nbands, nbytes / 1024);
+
+  if (OutOfCore::enabled())
+    LOG.info("#> Moved the local tiles out of core, to %s (%lu KB).\n", Env::ooc_dir.c_str(),
+             OutOfCore::nbytes() / 1024);
+}
+
+template <class Weight, class Annotation>
+uint64_t CSCMatrix2D<Weight, Annotation>::split_rowgrps()
+{
+  // Enough bands for every thread to have two lanes, short of an explicit count.
+  uint32_t nthreads = omp_get_max_threads();
+  uint32_t nrowgrps = std::max<uint32_t>(local_rowgrps.size(), 1);
+  uint32_t nbands = Env::row_bands ? Env::row_bands
+                                   : nthreads > 1 ? (2 * nthreads + nrowgrps - 1) / nrowgrps : 1;
+
+  uint64_t nbytes = 0;
+  for (auto& rowgrp : local_rowgrps)
+  {
+    nbytes += split_rowgrp<false>(rowgrp, nbands);
+    nbytes += split_rowgrp<true>(rowgrp, nbands);
+  }
+  return nbytes;
+}
+
+template <class Weight, class Annotation>
+template <bool sink>
+uint64_t CSCMatrix2D<Weight, Annotation>::split_rowgrp(
+    typename Annotation::RowGrp& rowgrp, uint32_t nbands)
+{
+  uint32_t nrows = sink ? rowgrp.globally_sink->count() : rowgrp.globally_regular->count();
+  uint32_t bitwidth = BitVector::get_bitwidth();
+  uint32_t nwords = (nrows + bitwidth - 1) / bitwidth;
+
+  // Nonzeros per bitvector word of rows, across the local tiles.
+  std::vector<uint64_t> nnzs(nwords);
+  uint64_t total = 0;
+
+  for (auto tile : rowgrp.local_tiles)
+  {
+    auto csc = sink ? tile->sink_csc : tile->csc;
+    for (uint32_t e = 0; e < csc->nentries; e++)
+      nnzs[csc->entries[e].global_idx / bitwidth]++;
+    total += csc->nentries;
+  }
+
+  if (not Env::row_bands)
+    nbands = std::min<uint64_t>(nbands, std::max<uint64_t>(total / BAND_MIN_NNZ, 1));
+
+  if (nbands <= 1 or nwords <= 1)
+    return 0;
+
+  // Cut after the word that reaches each next quantile of the nonzeros.
+  std::vector<uint32_t> bounds = {0};
+  uint64_t nnz = 0;
+  for (uint32_t w = 0; w < nwords - 1 and bounds.size() < nbands; w++)
+  {
+    nnz += nnzs[w];
+    if (nnz * nbands >= total * bounds.size())
+      bounds.push_back((w + 1) * bitwidth);
+  }
+  bounds.push_back(nrows);
+
+  if (sink)
+    rowgrp.sink_nbands = bounds.size() - 1;
+  else
+    rowgrp.nbands = bounds.size() - 1;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (uint32_t t = 0; t < rowgrp.local_tiles.size(); t++)
+  {
+    auto tile = rowgrp.local_tiles[t];
+    (sink ? tile->sink_csc : tile->csc)->split(bounds);
+  }
+
+  uint64_t nbytes = 0;
+  for (auto tile : rowgrp.local_tiles)
+    nbytes += (bounds.size() - 2) * (uint64_t) tile->csc->ncols * sizeof(uint32_t);
+  return nbytes;
 }
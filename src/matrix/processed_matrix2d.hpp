@@ -5,6 +5,7 @@
 #include <climits>
 #include <cmath>
 #include <mpi.h>
+#include "utils/dist_timer.h"
 
 
 /**
@@ -18,6 +19,8 @@ ProcessedMatrix2D<Weight, Annotation>::ProcessedMatrix2D(
 {
   assert(tile_width == tile_height);
 
+  Memory::Scope scope(MemoryCategory::GROUPS);  // (Of the bitvectors below.)
+
   for (auto& rowgrp : local_rowgrps)
   {
     rowgrp.locator = new Locator(rowgrp.range());
@@ -110,7 +113,10 @@ void ProcessedMatrix2D<Weight, Annotation>::distribute()
   assert(!already_distributed);
 
   Base::distribute();
-  preprocess();
+  {
+    TraceSpan span("Preprocessing");
+    preprocess();
+  }
 
   already_distributed = true;
 }
@@ -104,6 +104,8 @@ void ProcessedMatrix2D<Weight, Annotation>::gather_rowgrps_bvs()
   {
     for (auto& m : db.rowgrp_ranks_meta)
     {
+      m.other.union_with(m.regular);         // other == sink
+      m.other.intersect_with(*db.sink);
       m.regular.intersect_with(*db.regular);
       rowgrp_outblobs.push_back(db.regular->isend(
           m.rank, Dashboard::rowgrp_tag(db.rg), Env::MPI_WORLD, &req));
@@ -1,9 +1,11 @@
 #ifndef BIT_VECTOR_H
 #define BIT_VECTOR_H
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <cstdint>
+#include "utils/memory.h"
 
 
 class BitVector
@@ -22,36 +24,52 @@ protected:
 
   uint32_t* nnzs;
 
+  /**
+   * One bit per word, set once the word may be non-zero (i.e., since the last clear()), so that
+   * clearing a sparse bitvector only touches the words that were. A writer that sets bits in a
+   * zero word marks it (see mark()); unsetting bits leaves it marked. Allocated after the buffer.
+   **/
+  uint32_t* summary;
+
   uint32_t pos = 0;
 
   uint32_t cache = 0;
 
   bool owns_words = true;
 
+  MemoryCharge charge;  // (Under the allocating scope's category, see Memory.)
+
 public:  /* Constructor(s) and Destructor(s). */
 
   BitVector() {}  // for FixedVector allocation
 
   BitVector(uint32_t n)
-      : n(n), words(new uint32_t[buffer_nwords()]()), nnzs(words)
+      : n(n), words(new uint32_t[buffer_nwords() + summary_nwords()]()), nnzs(words)
   {
     //LOG.info("BitVector(n)\n");
+    charge.add((buffer_nwords() + summary_nwords()) * sizeof(uint32_t));
     *nnzs = 0;
+    summary = words + buffer_nwords();
     words++;
     rewind();
   }
 
   // Copy constructor: deep copy by default.
   BitVector(const BitVector& bv, bool deep = true)
-      : n(bv.n), words(deep ? (new uint32_t[buffer_nwords()]) : bv.buffer()), nnzs(words)
+      : n(bv.n),
+        words(deep ? (new uint32_t[buffer_nwords() + summary_nwords()]) : bv.buffer()),
+        nnzs(words)
   {
     //LOG.info("BitVector(bv)\n");
     owns_words = deep;
+    summary = deep ? words + buffer_nwords() : bv.summary;
     words++;
     if (deep)
     {
+      charge.add((buffer_nwords() + summary_nwords()) * sizeof(uint32_t));
       rewind();
       memcpy(buffer(), bv.buffer(), buffer_nbytes());
+      memcpy(summary, bv.summary, summary_nwords() * sizeof(uint32_t));
     }
   }
 
@@ -89,6 +107,7 @@ public:  /* General Interface. */
   {
     uint32_t x = idx >> lg_bitwidth;
     uint32_t orig = words[x];
+    if (orig == 0) mark(x);
     words[x] |= 1 << (idx & bitwidth_mask);
     uint32_t diff = (orig != words[x]);
     *nnzs += diff;
@@ -110,15 +129,45 @@ public:  /* General Interface. */
     return words[idx >> lg_bitwidth] & (1 << (idx & bitwidth_mask));
   }
 
-  void clear()
+  void clear() { clear([](uint32_t) {}); }
+
+  /**
+   * Visit the indices set, in order, while clearing them. Only the marked words (see summary)
+   * are visited, unless dense: a no-op (but for rewind()) if nothing was set since the last one.
+   **/
+  template <class Visitor>
+  void clear(Visitor visit)
   {
-    memset(buffer(), 0, buffer_nbytes());
+    uint32_t nwords = vector_nwords();
+
+    if (count() >= nwords)  // (Dense.)
+    {
+      for_each(0, nwords, visit);
+      memset(buffer(), 0, buffer_nbytes());
+      memset(summary, 0, summary_nwords() * sizeof(uint32_t));
+    }
+    else
+    {
+      for (uint32_t s = 0; s < summary_nwords(); s++)
+      {
+        for (uint32_t marks = summary[s]; marks; marks &= marks - 1)
+        {
+          uint32_t x = (s << lg_bitwidth) + __builtin_ctz(marks);
+          for_each(x, x + 1, visit);
+          words[x] = 0;
+        }
+        summary[s] = 0;
+      }
+      *nnzs = 0;
+    }
+
     rewind();
   }
 
   void fill()
   {
     memset(buffer(), 0xFFFFFFFF, buffer_nbytes());
+    mark(0, vector_nwords());
     *nnzs = n;
     rewind();
   }
@@ -127,6 +176,7 @@ public:  /* General Interface. */
   {
     nwords_to_fill = std::min(nwords_to_fill, vector_nwords() - from_word);
     memset(words + from_word, 0xFFFFFFFF, nwords_to_fill * sizeof(uint32_t));
+    mark(from_word, from_word + nwords_to_fill);
     *nnzs = nwords_to_fill * bitwidth;
     rewind();
   }
@@ -149,6 +199,87 @@ public:  /* Streaming Interface. */
       return next(idx);
   }
 
+public:  /* Range Interface (e.g., for threads over disjoint ranges of words). */
+
+  /** Visit the indices set within words [from_word, to_word), in order. Read-only. **/
+  template <class Visitor>
+  void for_each(uint32_t from_word, uint32_t to_word, Visitor visit) const
+  {
+    to_word = std::min(to_word, vector_nwords());
+    for (uint32_t x = from_word; x < to_word; x++)
+    {
+      for (uint32_t word = words[x]; word; word &= word - 1)
+      {
+        uint32_t idx = (x << lg_bitwidth) + __builtin_ctz(word);
+        if (idx < n) visit(idx);  // (Not the sentinel.)
+      }
+    }
+  }
+
+  /** The number of indices set within words [from_word, to_word). **/
+  uint32_t count(uint32_t from_word, uint32_t to_word) const
+  {
+    to_word = std::min(to_word, vector_nwords());
+    uint32_t k = 0;
+    for (uint32_t x = from_word; x < to_word; x++)
+      k += __builtin_popcount(words[x]);
+
+    uint32_t sentinel_word = n >> lg_bitwidth;  // (Not the sentinel.)
+    if (from_word <= sentinel_word and sentinel_word < to_word and check(n))
+      k--;
+    return k;
+  }
+
+  /**
+   * touch(), by one of several writers over disjoint ranges of words: returns 1 iff newly set,
+   * and leaves the count alone; each writer then adds up its own with add_count().
+   **/
+  uint32_t touch_uncounted(uint32_t idx)
+  {
+    uint32_t x = idx >> lg_bitwidth;
+    uint32_t orig = words[x];
+    if (orig == 0)  // (Other writers may mark the same word of the summary.)
+      __atomic_fetch_or(&summary[x >> lg_bitwidth], 1u << (x & bitwidth_mask), __ATOMIC_RELAXED);
+    words[x] |= 1 << (idx & bitwidth_mask);
+    return orig != words[x];
+  }
+
+  void add_count(uint32_t k) { __atomic_fetch_add(nnzs, k, __ATOMIC_RELAXED); }
+
+public:  /* Read-only Streaming Interface (any number of concurrent readers, no allocation). */
+
+  /** Streams the set indices like next(), off its own position and word cache. **/
+  class Cursor
+  {
+    const uint32_t* words;
+
+    uint32_t n;
+
+    uint32_t pos = 0;
+
+    uint32_t cache = 0;
+
+  public:
+    // Requires the sentinel bit, as set by rewind(), and no writers while in use.
+    Cursor(const BitVector& bv) : words(bv.words), n(bv.n) { assert(bv.check(bv.n)); }
+
+    bool next(uint32_t& idx)
+    {
+      while (words[pos] == 0)
+        pos++;
+      cache = cache ? cache : words[pos];
+
+      uint32_t lsb = __builtin_ctz(cache);
+      cache ^= 1 << lsb;
+      idx = (pos << lg_bitwidth) + lsb;
+
+      pos += (cache == 0);
+      return idx < n;
+    }
+  };
+
+  Cursor cursor() const { return Cursor(*this); }
+
 public:  /* Set Interface. */
   void union_with(BitVector const& bv);
 
@@ -178,6 +309,21 @@ protected:  /* Buffer contains the non-zeros count, followed by a vector of n+1
     return buffer_nwords() * sizeof(uint32_t);
   }
 
+  uint32_t summary_nwords() const
+  {
+    uint32_t nwords = vector_nwords();
+    return nwords / bitwidth + (nwords % bitwidth > 0);
+  }
+
+  /* Mark the word x (resp. the words [from_word, to_word)) as possibly non-zero. */
+  void mark(uint32_t x) { summary[x >> lg_bitwidth] |= 1u << (x & bitwidth_mask); }
+
+  void mark(uint32_t from_word, uint32_t to_word)
+  {
+    for (uint32_t x = from_word; x < to_word; x++)
+      mark(x);
+  }
+
 public:
   static uint32_t get_bitwidth() { return bitwidth; }
 
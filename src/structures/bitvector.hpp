@@ -58,6 +58,9 @@ void BitVector::union_with(BitVector const& bv)
     nnzs_ += __builtin_popcount(words[i]);
   }
 
+  for (uint32_t s = 0; s < summary_nwords(); s++)
+    summary[s] |= bv.summary[s];
+
   *nnzs = nnzs_ - 1;
 }
 
@@ -1,6 +1,11 @@
 #ifndef COMMUNICABLE_H
 #define COMMUNICABLE_H
 
+#include "structures/local_mailbox.h"
+#include "structures/neighbor_exchange.h"
+#include "structures/shared_window.h"
+#include "utils/dist_timer.h"
+#include "utils/memory.h"
 
 /**
  * Offers MPI-based communication interface: isend/irecv() with isend/irecv_postprocess().
@@ -34,11 +39,14 @@ public:
 
   void* new_blob()
   {
-    return Array::new_blob(blob_nbytes_max());
+    void* blob = Array::new_blob(blob_nbytes_max());
+    Memory::allocated_blob(blob, blob_nbytes_max());
+    return blob;
   }
 
   void delete_blob(void* blob)
   {
+    Memory::freed_blob(blob);
     Array::delete_blob(blob);
   }
 
@@ -57,26 +65,35 @@ public:
     return Array::blob_nbytes(Array::size());
   }
 
+  /** Serialize into a new blob of nbytes (e.g., to save it; see Checkpoint). **/
   template <bool destructive = false>
-  void* isend(int32_t rank, int32_t tag, MPI_Comm comm, MPI_Request* request)
+  void* serialize(uint32_t& nbytes)
   {
+    TraceSpan span("Serialization");
+
     void* blob = nullptr;
-    uint32_t nbytes;
 
     // "IF" this is determined statically, the compiler should optimize this branch away.
     if (std::is_base_of<Serializable, typename Array::Type>::value)
-    {
       // We will create the blob dynamically during serialization (passing ptr by reference).
       nbytes = Array::template serialize_into<destructive>(blob);
-      MPI_Isend(blob, nbytes, MPI_BYTE, rank, tag, comm, request);
-    }
     else
     {
       blob = Array::new_blob(blob_nbytes_tight());
       nbytes = Array::template serialize_into<destructive>(blob);
-      MPI_Isend(blob, nbytes, MPI_BYTE, rank, tag, comm, request);
     }
 
+    Memory::allocated_blob(blob, nbytes);
+    return blob;
+  }
+
+  template <bool destructive = false>
+  void* isend(int32_t rank, int32_t tag, MPI_Comm comm, MPI_Request* request)
+  {
+    uint32_t nbytes;
+    void* blob = serialize<destructive>(nbytes);
+    MPI_Isend(blob, nbytes, MPI_BYTE, rank, tag, comm, request);
+
     if(rank != Env::rank) Env::nbytes_sent += nbytes;
     return blob;
   }
@@ -110,16 +127,169 @@ public:
     }
   }
 
-  void irecv_postprocess(void* blob)
+  /* Deserialize and free the blob; returns its nbytes (e.g., for Env::nbytes_recvd). */
+  uint32_t irecv_postprocess(void* blob)
+  {
+    TraceSpan span("Deserialization");
+    uint32_t nbytes = Array::deserialize_from(blob);
+    delete_blob(blob);
+    return nbytes;
+  }
+
+  /** Cancel an irecv() that is yet to match (e.g., once no more messages are due). **/
+  void cancel_irecv(void* blob, MPI_Request* request)
   {
-    Array::deserialize_from(blob);
+    MPI_Cancel(request);
+    MPI_Wait(request, MPI_STATUS_IGNORE);
     delete_blob(blob);
   }
 
-  void irecv_postprocess(void* blob, uint32_t sub_size)
+  uint32_t irecv_postprocess(void* blob, uint32_t sub_size)
   {
-    Array::deserialize_from(blob, sub_size);
+    uint32_t nbytes = Array::deserialize_from(blob, sub_size);
     delete_blob(blob);
+    return nbytes;
+  }
+
+  /*
+   * Persistent communication: a blob of blob_nbytes_max() is allocated once and bound to a
+   * persistent request, then reused by every round until unbind(). Only meaningful for
+   * trivially-serializable types (dynamic blobs are sized per message).
+   */
+
+  void* send_init(int32_t rank, int32_t tag, MPI_Comm comm, MPI_Request* request)
+  {
+    void* blob = new_blob();
+    MPI_Send_init(blob, blob_nbytes_max(), MPI_BYTE, rank, tag, comm, request);
+    return blob;
+  }
+
+  void* recv_init(int32_t rank, int32_t tag, MPI_Comm comm, MPI_Request* request)
+  {
+    void* blob = new_blob();
+    MPI_Recv_init(blob, blob_nbytes_max(), MPI_BYTE, rank, tag, comm, request);
+    return blob;
+  }
+
+  /**
+   * Serialize into a bound blob and send it. A bound send always puts blob_nbytes_max() bytes on
+   * the wire, so a blob that serializes to less than half of that is sent with a plain isend of
+   * its meaningful bytes instead (from the same, already allocated, blob).
+   * Either way, *request is the request to complete before the blob is reused.
+   **/
+  template <bool destructive = false>
+  void start_send(void* blob, int32_t rank, int32_t tag, MPI_Comm comm,
+                  MPI_Request* bound_request, MPI_Request* request)
+  {
+    TraceSpan span("Serialization");
+    uint32_t nbytes = Array::template serialize_into<destructive>(blob);
+    uint32_t nbytes_max = blob_nbytes_max();
+    assert(nbytes <= nbytes_max);
+
+    if (nbytes * 2 < nbytes_max)
+      MPI_Isend(blob, nbytes, MPI_BYTE, rank, tag, comm, request);
+    else
+    {
+      MPI_Start(bound_request);
+      *request = *bound_request;
+      nbytes = nbytes_max;
+    }
+
+    if (rank != Env::rank) Env::nbytes_sent += nbytes;
+  }
+
+  /** Like irecv_postprocess(), but leaves the (bound) blob allocated for the next round. **/
+  uint32_t recv_postprocess(void* blob)
+  {
+    TraceSpan span("Deserialization");
+    return Array::deserialize_from(blob);
+  }
+
+  /** Free a bound blob and its (inactive) persistent request. **/
+  void unbind(void* blob, MPI_Request* bound_request)
+  {
+    MPI_Request_free(bound_request);
+    delete_blob(blob);
+  }
+
+  /*
+   * Shared-memory transport for bound requests between co-located ranks (see SharedWindow).
+   * The bound blob here is only the (uint64_t) slot offset sent as a notification.
+   */
+
+  void* send_init_shared(SharedWindow* window, int32_t rank, int32_t tag, MPI_Comm comm,
+                         MPI_Request* request)
+  {
+    uint64_t* offset = new uint64_t(window->reserve(blob_nbytes_max()));
+    MPI_Send_init(offset, sizeof(uint64_t), MPI_BYTE, rank, tag, comm, request);
+    return offset;
+  }
+
+  void* recv_init_shared(int32_t rank, int32_t tag, MPI_Comm comm, MPI_Request* request)
+  {
+    uint64_t* offset = new uint64_t;
+    MPI_Recv_init(offset, sizeof(uint64_t), MPI_BYTE, rank, tag, comm, request);
+    return offset;
+  }
+
+  template <bool destructive = false>
+  void start_send_shared(SharedWindow* window, void* offset, MPI_Request* bound_request,
+                         MPI_Request* request)
+  {
+    SharedWindow::Slot* slot = window->local(*(uint64_t*) offset);
+
+    // Wait for the receiver to be done with the previous round, if it is not already.
+    while (slot->busy.load(std::memory_order_acquire))
+      Env::progress();
+    slot->busy.store(1, std::memory_order_relaxed);
+
+    TraceSpan span("Serialization");
+    void* blob = slot->blob();
+    uint32_t nbytes = Array::template serialize_into<destructive>(blob);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    MPI_Start(bound_request);
+    *request = *bound_request;
+    Env::nbytes_sent += nbytes;  // (Through the window, besides the offset over MPI.)
+  }
+
+  uint32_t recv_postprocess_shared(SharedWindow* window, int32_t rank, void* offset)
+  {
+    TraceSpan span("Deserialization");
+    uint32_t nbytes = Array::deserialize_from(peek_shared(window, rank, offset));
+    release_shared(window, rank, offset);
+    return nbytes;
+  }
+
+  /** The blob received through the window, to be read in place until release_shared(). **/
+  const void* peek_shared(SharedWindow* window, int32_t rank, void* offset)
+  {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return window->peer(rank, *(uint64_t*) offset)->blob();
+  }
+
+  void release_shared(SharedWindow* window, int32_t rank, void* offset)
+  {
+    window->peer(rank, *(uint64_t*) offset)->busy.store(0, std::memory_order_release);
+  }
+
+  void unbind_shared(void* offset, MPI_Request* bound_request)
+  {
+    MPI_Request_free(bound_request);
+    delete (uint64_t*) offset;
+  }
+
+  /*
+   * Neighborhood-collective transport (see NeighborExchange): serialize straight into the
+   * channel's slot; the receiver deserializes in place with recv_postprocess().
+   */
+
+  template <bool destructive = false>
+  void send_exchange(NeighborExchange* exchange, uint32_t channel)
+  {
+    TraceSpan span("Serialization");
+    void* blob = exchange->send_blob(channel);
+    exchange->sent(channel, Array::template serialize_into<destructive>(blob));
   }
 
   static void
@@ -140,6 +310,7 @@ public:
       MPI_Get_count(&status_, MPI_BYTE, &count);
 
       the_blobs[i] = new char[count];
+      Memory::allocated_blob(the_blobs[i], count);
 
       MPI_Irecv(the_blobs[i], count, MPI_BYTE, source, tag, Env::MPI_WORLD, request);
     }
@@ -189,6 +360,7 @@ public:
 
           delete status;
           blob = new char[count];
+          Memory::allocated_blob(blob, count);
 
           MPI_Irecv(blob, count, MPI_BYTE, source, tag, Env::MPI_WORLD, &request);
           num_ready++;
@@ -211,6 +383,7 @@ public:
     MPI_Get_count(&status_, MPI_BYTE, &count);
 
     blob = new char[count];
+    Memory::allocated_blob(blob, count);
 
     MPI_Irecv(blob, count, MPI_BYTE, source, tag, Env::MPI_WORLD, request);
   }
@@ -0,0 +1,46 @@
+#ifndef LOCAL_MAILBOX_H
+#define LOCAL_MAILBOX_H
+
+#include <atomic>
+#include <cassert>
+
+
+/**
+ * Hand-off of a segment to its receiver on the same rank (see CommBackend::LOCAL).
+ *
+ * Rather than serializing into a blob and sending it to itself through MPI, the sender writes
+ * (or swaps) the segment straight into the receiver's array, then post()'s. The receiver's
+ * blob is pending() until it take()'s the delivery, which needs no post-processing.
+ *
+ * As with MPI, every post() matches one receive, and the receiver must have consumed the
+ * previous delivery (as bulk-synchronous iterations do) before the sender writes the next one.
+ **/
+
+class LocalMailbox
+{
+public:
+  /** Placeholder for blobs delivered in place, by a sender on the same rank. **/
+  static void* pending()
+  {
+    static char placeholder;
+    return &placeholder;
+  }
+
+  void post()
+  {
+    assert(not full.load());
+    full.store(true, std::memory_order_release);
+  }
+
+  /** Has a delivery been posted since the last take()? **/
+  bool take()
+  {
+    return full.load(std::memory_order_acquire) and full.exchange(false);
+  }
+
+private:
+  std::atomic<bool> full{false};
+};
+
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef NEIGHBOR_EXCHANGE_H
+#define NEIGHBOR_EXCHANGE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <mpi.h>
+#include "utils/env.h"
+#include "utils/memory.h"
+
+
+/**
+ * Neighborhood-collective exchange of segments (see CommBackend::NEIGHBORHOOD).
+ *
+ * Each segment registers one channel per peer it sends to (or recvs from), then build() creates
+ * a distributed-graph communicator whose neighbors are exactly these peers (collective over
+ * Env::MPI_WORLD). Every round, the senders serialize into their channels' slots, then start()
+ * exchanges all of them at once with MPI_Ineighbor_alltoallv, and wait() locates the received
+ * blobs, which are deserialized in place.
+ *
+ * Every channel must be sent exactly once per round, and all ranks must start() the same
+ * number of rounds.
+ *
+ * Layout: per neighbor, the channels in tag order, each as a header (its nbytes) followed by
+ * the blob. Slots are sized for the largest blob of their channel; start() compacts each
+ * neighbor's slots down to the actual blobs, and only these bytes (whose count is exchanged
+ * first) are sent.
+ **/
+
+class NeighborExchange
+{
+public:
+  /* Blobs (and their headers) start at this alignment, as they would if allocated alone. */
+  static constexpr uint32_t ALIGNMENT = alignof(std::max_align_t);
+
+  /** Placeholder for blobs yet to be received through an exchange. **/
+  static void* pending()
+  {
+    static char placeholder;
+    return &placeholder;
+  }
+
+private:
+  struct Channel
+  {
+    int32_t rank;
+    uint32_t tag;
+    uint32_t max_nbytes;
+    uint32_t nbytes;
+    uint64_t offset;  // of its slot
+    char* blob;       // (recv channels) as received
+  };
+
+  struct Side
+  {
+    std::vector<Channel> channels;
+    std::vector<int> ranks;                       // neighbors
+    std::vector<std::vector<uint32_t>> ordered;   // channels, per neighbor, in tag order
+    std::vector<int> counts, displs;              // per neighbor, in bytes
+    char* buffer = nullptr;
+    uint64_t nbytes = 0;
+    MemoryCharge charge;
+
+    uint32_t add(int32_t rank, uint32_t tag, uint32_t max_nbytes)
+    {
+      channels.push_back({rank, tag, max_nbytes, UINT32_MAX, 0, nullptr});
+      return channels.size() - 1;
+    }
+
+    void layout()
+    {
+      for (auto& ch : channels)
+        ranks.push_back(ch.rank);
+      std::sort(ranks.begin(), ranks.end());
+      ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+
+      ordered.resize(ranks.size());
+      for (uint32_t c = 0; c < channels.size(); c++)
+        ordered[neighbor(channels[c].rank)].push_back(c);
+
+      counts.resize(ranks.size());
+      displs.resize(ranks.size());
+
+      for (uint32_t n = 0; n < ranks.size(); n++)
+      {
+        std::sort(ordered[n].begin(), ordered[n].end(),
+                  [&](uint32_t a, uint32_t b) { return channels[a].tag < channels[b].tag; });
+        displs[n] = nbytes;
+        for (auto c : ordered[n])
+        {
+          channels[c].offset = nbytes;
+          nbytes += slot_nbytes(channels[c].max_nbytes);
+        }
+        assert(nbytes <= INT32_MAX);
+      }
+
+      buffer = new char[nbytes + 1];
+      charge.add(MemoryCategory::BLOBS, nbytes + 1);
+    }
+
+    uint32_t neighbor(int32_t rank) const
+    {
+      return std::lower_bound(ranks.begin(), ranks.end(), rank) - ranks.begin();
+    }
+  };
+
+  Side sends, recvs;
+
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  MPI_Request request = MPI_REQUEST_NULL;
+
+  static uint64_t slot_nbytes(uint32_t blob_nbytes)
+  {
+    return ALIGNMENT + (blob_nbytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+
+public:
+
+  ~NeighborExchange()
+  {
+    wait();
+    if (comm != MPI_COMM_NULL)
+      MPI_Comm_free(&comm);
+    delete[] sends.buffer;
+    delete[] recvs.buffer;
+  }
+
+  /** Register a channel to (or from) the given rank, for blobs of at most max_nbytes. **/
+  uint32_t add_send(int32_t rank, uint32_t tag, uint32_t max_nbytes)
+  {
+    assert(not built());
+    return sends.add(rank, tag, max_nbytes);
+  }
+
+  uint32_t add_recv(int32_t rank, uint32_t tag, uint32_t max_nbytes)
+  {
+    assert(not built());
+    return recvs.add(rank, tag, max_nbytes);
+  }
+
+  /** Collective over Env::MPI_WORLD, after all channels are registered. **/
+  void build()
+  {
+    assert(not built());
+    sends.layout();
+    recvs.layout();
+
+    MPI_Dist_graph_create_adjacent(Env::MPI_WORLD,
+                                   recvs.ranks.size(), recvs.ranks.data(), MPI_UNWEIGHTED,
+                                   sends.ranks.size(), sends.ranks.data(), MPI_UNWEIGHTED,
+                                   MPI_INFO_NULL, 0 /* no reorder */, &comm);
+  }
+
+  bool built() const { return comm != MPI_COMM_NULL; }
+
+  /** The slot to serialize the channel's blob into (of up to its max_nbytes). **/
+  void* send_blob(uint32_t channel)
+  {
+    return sends.buffer + sends.channels[channel].offset + ALIGNMENT;
+  }
+
+  void sent(uint32_t channel, uint32_t nbytes)
+  {
+    assert(nbytes <= sends.channels[channel].max_nbytes);
+    sends.channels[channel].nbytes = nbytes;
+  }
+
+  /** Exchange this round's blobs (once all channels are sent). **/
+  void start()
+  {
+    assert(built() and request == MPI_REQUEST_NULL);
+
+    // Compact each neighbor's blobs, behind their headers.
+    for (uint32_t n = 0; n < sends.ranks.size(); n++)
+    {
+      uint64_t cursor = sends.displs[n];
+      for (auto c : sends.ordered[n])
+      {
+        auto& ch = sends.channels[c];
+        assert(ch.nbytes != UINT32_MAX);  // Sent this round.
+
+        if (cursor != ch.offset)
+          memmove(sends.buffer + cursor + ALIGNMENT, sends.buffer + ch.offset + ALIGNMENT,
+                  ch.nbytes);
+        memcpy(sends.buffer + cursor, &ch.nbytes, sizeof(uint32_t));
+        cursor += slot_nbytes(ch.nbytes);
+        ch.nbytes = UINT32_MAX;
+      }
+
+      sends.counts[n] = cursor - sends.displs[n];
+      if (sends.ranks[n] != Env::rank) Env::nbytes_sent += sends.counts[n];
+    }
+
+    MPI_Neighbor_alltoall(sends.counts.data(), 1, MPI_INT, recvs.counts.data(), 1, MPI_INT, comm);
+
+    MPI_Ineighbor_alltoallv(sends.buffer, sends.counts.data(), sends.displs.data(), MPI_BYTE,
+                            recvs.buffer, recvs.counts.data(), recvs.displs.data(), MPI_BYTE,
+                            comm, &request);
+  }
+
+  /** Complete the current round, if any, and locate the received blobs. **/
+  void wait()
+  {
+    if (request == MPI_REQUEST_NULL)
+      return;
+
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+
+    for (uint32_t n = 0; n < recvs.ranks.size(); n++)
+    {
+      uint64_t cursor = recvs.displs[n];
+      for (auto c : recvs.ordered[n])
+      {
+        auto& ch = recvs.channels[c];
+        memcpy(&ch.nbytes, recvs.buffer + cursor, sizeof(uint32_t));
+        ch.blob = recvs.buffer + cursor + ALIGNMENT;
+        cursor += slot_nbytes(ch.nbytes);
+      }
+      assert(cursor - recvs.displs[n] == (uint64_t) recvs.counts[n]);
+    }
+  }
+
+  /** The channel's blob of the last completed round. **/
+  void* recv_blob(uint32_t channel) { return recvs.channels[channel].blob; }
+
+  bool owns(const void* blob) const
+  {
+    return blob >= recvs.buffer and blob < recvs.buffer + recvs.nbytes;
+  }
+};
+
+
+#endif
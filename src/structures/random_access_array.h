@@ -2,6 +2,7 @@
 #define RANDOM_ACCESS_ARRAY_
 
 #include "structures/serializable_bitvector.h"
+#include "utils/out_of_core.h"
 
 
 template <class Value>
@@ -18,6 +19,8 @@ protected:
 
   Value* vals;
 
+  MemoryCharge charge;  // (Under the allocating scope's category, see Memory.)
+
 public: /* Constructor(s), Destructor(s), and Random Access Operations. */
 
   RandomAccessArray() {}  // for FixedVector allocation
@@ -25,11 +28,14 @@ public: /* Constructor(s), Destructor(s), and Random Access Operations. */
   // A default-initialized array of size n.
   RandomAccessArray(uint32_t n)
       : activity(new ActivitySet(n)), n(n), vals(new Value[n + 1]())
-  { rewind(); }
+  {
+    charge.add((n + 1) * sizeof(Value));
+    rewind();
+  }
 
   ~RandomAccessArray()
   {
-    delete[] vals;
+    OutOfCore::free_array(vals);
     vals = nullptr;
     delete activity;
     activity = nullptr;
@@ -42,20 +48,25 @@ public: /* Constructor(s), Destructor(s), and Random Access Operations. */
     n = n_;
   }
 
+  /** Move the values to the out-of-core file, if large enough (see OutOfCore::spill_array()). **/
+  void spill() { vals = OutOfCore::spill_array(vals, n + 1); }
+
   // Only touches the values array -- not the bitvector.
   void fill(const Value& val) { std::fill(vals, vals + n, val); }
 
-  void clear()
-  {
-    uint32_t idx;
-    Value val;
-    rewind();
-    while (pop(idx, val)) { /* Do nothing */ }
-    rewind();
-  }
+  // Re-initializes the active entries only (see BitVector::clear()).
+  void clear() { activity->clear([this](uint32_t idx) { vals[idx] = Value(); }); }
 
   Value& operator[](uint32_t idx) { return vals[idx]; }
 
+  /* Exchange contents with an array of the same size (e.g., to deliver it without a copy). */
+  void swap(RandomAccessArray& other)
+  {
+    assert(n == other.n);
+    std::swap(activity, other.activity);
+    std::swap(vals, other.vals);
+  }
+
   uint32_t size() const { return n; }
 
   /* Non-copyable. */
@@ -102,12 +113,19 @@ public:  /* Serialization Interface. */
   template <bool destructive = false>
   uint32_t serialize_into(void*& blob);
 
-  void deserialize_from(const void* blob);
+  uint32_t deserialize_from(const void* blob);
 
   template <bool destructive = false>
   uint32_t serialize_into_dynamic(void*& blob);
 
-  void deserialize_from_dynamic(const void* blob);
+  uint32_t deserialize_from_dynamic(const void* blob);
+
+  /**
+   * Read a blob in place rather than deserialize it: decode its activity into activity_ (clear,
+   * and of this size), and return its values, which follow in the order of the active indices.
+   * Trivially-serializable values only.
+   **/
+  const Value* decode_blob(const void* blob, ActivitySet& activity_);
 
 protected:  /* Serialization Implementation. */
 
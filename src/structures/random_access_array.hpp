@@ -29,13 +29,10 @@ uint32_t RandomAccessArray<Value>::serialize_into(void*& blob)
 }
 
 template <class Value>
-void RandomAccessArray<Value>::deserialize_from(const void* blob)
+uint32_t RandomAccessArray<Value>::deserialize_from(const void* blob)
 {
   if (std::is_base_of<Serializable, Value>::value)
-  {
-    deserialize_from_dynamic(blob);
-    return;
-  }
+    return deserialize_from_dynamic(blob);
 
   uint32_t activity_nbytes = activity->deserialize_from(blob);
   uint32_t values_nbytes = activity->count() * sizeof(Value);  // Must be after deserialize_from()
@@ -47,6 +44,19 @@ void RandomAccessArray<Value>::deserialize_from(const void* blob)
   while (activity->next(idx))
     vals[idx] = values[x++];
   rewind();
+
+  return (char*) (values + x) - (char*) blob;
+}
+
+template <class Value>
+const Value* RandomAccessArray<Value>::decode_blob(const void* blob, ActivitySet& activity_)
+{
+  assert(activity_.count() == 0);
+  uint32_t activity_nbytes = activity_.deserialize_from(blob);
+  uint32_t values_nbytes = activity_.count() * sizeof(Value);  // Must be after deserialize_from()
+  activity_.rewind();
+
+  return blob_values_offset(blob, activity_nbytes, values_nbytes);
 }
 
 template <class Value>
@@ -76,8 +86,7 @@ uint32_t RandomAccessArray<Value>::serialize_into_dynamic(void*& blob)
     blob = new char[activity_nbytes];
 
     // Serialize activity into blob.
-    uint32_t activity_nbytes_ = activity->serialize_into<false /* NOT destructive! */>(blob);
-    assert(activity_nbytes == activity_nbytes_);
+    activity_nbytes = activity->serialize_into<false /* NOT destructive! */>(blob);
 
     rewind();
 
@@ -86,8 +95,7 @@ uint32_t RandomAccessArray<Value>::serialize_into_dynamic(void*& blob)
 
   // Serialize activity into temporary blob.
   char* tmp_blob = new char[activity_nbytes];
-  uint32_t activity_nbytes_ = activity->serialize_into<false /* NOT destructive! */>(tmp_blob);
-  assert(activity_nbytes == activity_nbytes_);
+  activity_nbytes = activity->serialize_into<false /* NOT destructive! */>(tmp_blob);
 
   // Serialize values into bytestrings.
   std::string* values = new std::string[nactive];
@@ -116,8 +124,10 @@ uint32_t RandomAccessArray<Value>::serialize_into_dynamic(void*& blob)
   /* Format: (activity), (nactive * uint32_t (sizes)), (char * sizes[0]) ... (char * sizes[nactive-1]). */
 
   // Calculate blob size.
+  // (An encoded activity may take any nbytes: the sizes that follow are padded to alignment.)
+  uint32_t sizes_offset = (activity_nbytes + alignof(uint32_t) - 1) & ~(alignof(uint32_t) - 1);
   uint32_t sizes_nbytes = sizeof(uint32_t) * nactive;
-  uint32_t blob_nbytes = activity_nbytes + sizes_nbytes + values_nbytes;
+  uint32_t blob_nbytes = sizes_offset + sizes_nbytes + values_nbytes;
 
   // Allocate blob.
   blob = new char[blob_nbytes];
@@ -149,7 +159,7 @@ uint32_t RandomAccessArray<Value>::serialize_into_dynamic(void*& blob)
 }
 
 template <class Value>
-void RandomAccessArray<Value>::deserialize_from_dynamic(const void* blob)
+uint32_t RandomAccessArray<Value>::deserialize_from_dynamic(const void* blob)
 {
   uint32_t activity_nbytes = activity->deserialize_from(blob);
 
@@ -158,7 +168,7 @@ void RandomAccessArray<Value>::deserialize_from_dynamic(const void* blob)
   if (nactive == 0)
   {
     rewind();
-    return;
+    return activity_nbytes;
   }
 
   /* Format: (activity), (nactive * uint32_t (sizes)), (char * sizes[0]) ... (char * sizes[nactive-1]). */
@@ -186,13 +196,15 @@ void RandomAccessArray<Value>::deserialize_from_dynamic(const void* blob)
     stream<basic_array_source<char>> s(device);
     boost::archive::binary_iarchive ia(s);
     ia >> val;
-    vals[idx] = val;
+    vals[idx] = std::move(val);  // (Its payload, e.g., in the arena, is not copied.)
     values += sizes[x];
 
     values_nbytes += sizes[x];
     x++;
   }
   rewind();
+
+  return values - (char*) blob;
 }
 
 /*
@@ -3,6 +3,7 @@
 
 #include "structures/bitvector.h"
 #include "structures/communicable.h"
+#include "structures/wire_codec.h"
 
 
 class SerializableBitVector : public BitVector
@@ -20,6 +21,25 @@ public:  /* Constructor(s) and Destructor(s). */
   SerializableBitVector& operator=(SerializableBitVector const&) = delete;
 
 public:  /* Serialization Interface. */
+
+  /**
+   * Wire formats (codecs). A blob starts with the count, whose top CODEC_NBITS bits hold the
+   * codec (hence, a bitvector has fewer than 2^COUNT_NBITS bits).
+   *   PLAIN:   if dense, the whole buffer (count and words), as is; else, the indices, as
+   *            uint32_t's. (Both have no codec bits set.)
+   *   VARINT:  the gaps between consecutive indices, as variable-byte integers.
+   *   PACKED:  the gaps, bit-packed at the width of the largest one (preceded by that width).
+   *   RUNS:    the lengths of alternating runs of 0s and 1s (starting with 0s), as variable-byte
+   *            integers.
+   * The sender picks the smallest for each message: PLAIN or RUNS if dense, else PLAIN, VARINT,
+   * or PACKED.
+   **/
+  enum Codec : uint32_t { PLAIN = 0, VARINT = 1, PACKED = 2, RUNS = 3 };
+
+  static constexpr uint32_t CODEC_NBITS = 2;
+
+  static constexpr uint32_t COUNT_NBITS = 32 - CODEC_NBITS;
+
   template <bool destructive = false>
   uint32_t serialize_into(void* blob);
 
@@ -34,6 +54,7 @@ protected:  /* Serialization Implementation. */
 
   uint32_t blob_nbytes(uint32_t count) { return blob_nbytes(count, this->size()); }
 
+  // Upper bound (size of PLAIN).
   uint32_t blob_nbytes(uint32_t count, uint32_t size)
   {
     if (is_dense(count, size))
@@ -47,6 +68,22 @@ protected:  /* Serialization Implementation. */
   }
 
 private:  /* Further Serialization Implementation. */
+  uint32_t serialize_runs_into(uint32_t* out, uint32_t max_nbytes);
+
+  uint32_t serialize_gaps_into(uint32_t* out);
+
+  uint32_t deserialize_runs_from(const uint32_t* in, uint32_t count, uint32_t size);
+
+  uint32_t deserialize_gaps_from(const uint32_t* in, uint32_t count, Codec codec);
+
+  static uint32_t header(Codec codec, uint32_t count) { return (codec << COUNT_NBITS) | count; }
+
+  /* Index of the first bit at or after `from` that is (iff ones) on, or size() if none. */
+  uint32_t find_next(uint32_t from, bool ones) const;
+
+  /* Turn on the bits [from, from + length); does not update the count. */
+  void fill_range(uint32_t from, uint32_t length);
+
   bool is_dense() { return is_dense(this->count()); }
 
   bool is_dense(uint32_t count) { return is_dense(count, this->size()); }
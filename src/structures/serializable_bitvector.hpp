@@ -4,30 +4,135 @@ template <bool destructive>
 uint32_t SerializableBitVector::serialize_into(void* blob)
 {
   assert(check(this->size()));
+  assert(this->size() < (1u << COUNT_NBITS));
+
+  uint32_t* out = (uint32_t*) blob;
+  uint32_t nbytes;
 
   if (is_dense())
   {
     rewind();
     assert(this->buffer_nbytes() == blob_nbytes(this->count()));
-    uint32_t nbytes = this->buffer_nbytes();
-    memcpy(blob, this->buffer(), nbytes);
+    uint32_t words_nbytes = this->buffer_nbytes();
 
-    if (destructive)
-      this->clear();
-    return nbytes;
+    // Clustered bits (e.g., ranges of vertices) take much fewer bytes as runs.
+    nbytes = serialize_runs_into(out, words_nbytes);
+
+    if (nbytes == 0)
+    {
+      memcpy(out, this->buffer(), words_nbytes);  // (PLAIN: the count is the header.)
+      nbytes = words_nbytes;
+    }
   }
+  else
+    nbytes = serialize_gaps_into(out);
 
-  uint32_t idx, x = 0;
-  uint32_t* out = (uint32_t*) blob;
-  out[x++] = this->count();
-  assert(out[0] <= this->size());
+  if (destructive)
+    this->clear();
+  rewind();
+
+  return nbytes;
+}
+
+// Returns the number of bytes written, or zero if RUNS would not fit in max_nbytes.
+uint32_t SerializableBitVector::serialize_runs_into(uint32_t* out, uint32_t max_nbytes)
+{
+  // Every run takes at least a byte: first count the runs (i.e., the bit flips).
+  uint32_t nruns = 1, carry = 0, max = this->vector_nwords();
+  for (uint32_t i = 0; i < max; i++)
+  {
+    nruns += __builtin_popcount(words[i] ^ ((words[i] << 1) | carry));
+    carry = words[i] >> (bitwidth - 1);
+  }
+
+  if (sizeof(uint32_t) + nruns >= max_nbytes)
+    return 0;
+
+  out[0] = header(RUNS, this->count());
+
+  uint8_t* begin = (uint8_t*) out;
+  uint8_t* end = begin + max_nbytes;
+  uint8_t* ptr = (uint8_t*) (out + 1);
+
+  uint32_t from = 0;
+  bool ones = false;
+
+  while (from < this->size())
+  {
+    if (ptr + 5 > end)
+      return 0;  // Not worth it (and would not fit).
+
+    uint32_t to = find_next(from, not ones);
+    ptr = WireCodec::put_varint(ptr, to - from);
+    from = to;
+    ones = not ones;
+  }
+
+  return (uint32_t) (ptr - begin);
+}
+
+uint32_t SerializableBitVector::serialize_gaps_into(uint32_t* out)
+{
+  uint32_t count = this->count();
+  uint32_t idx, expected, gap;
 
+  // Size the candidate codecs, where a gap is the number of zeros skipped before an index.
+  uint32_t gaps_or = 0, varint_nbytes = 0;
+
+  expected = 0;
   rewind();
-  while (this->advance<destructive>(idx))
-    out[x++] = idx;
+  while (this->next(idx))
+  {
+    gap = idx - expected;
+    gaps_or |= gap;
+    varint_nbytes += WireCodec::varint_nbytes(gap);
+    expected = idx + 1;
+  }
   rewind();
 
-  return x * sizeof(uint32_t);
+  uint32_t width = WireCodec::bitwidth(gaps_or);
+  uint32_t list_nbytes = count * sizeof(uint32_t);
+  uint32_t packed_nbytes = (1 + WireCodec::packed_nwords(count, width)) * sizeof(uint32_t);
+
+  uint32_t nbytes = sizeof(uint32_t);
+
+  if (list_nbytes <= varint_nbytes and list_nbytes <= packed_nbytes)
+  {
+    out[0] = header(PLAIN, count);
+    uint32_t x = 1;
+    while (this->next(idx))
+      out[x++] = idx;
+    nbytes += list_nbytes;
+  }
+  else if (varint_nbytes <= packed_nbytes)
+  {
+    out[0] = header(VARINT, count);
+    uint8_t* ptr = (uint8_t*) (out + 1);
+    expected = 0;
+    while (this->next(idx))
+    {
+      ptr = WireCodec::put_varint(ptr, idx - expected);
+      expected = idx + 1;
+    }
+    nbytes += varint_nbytes;
+  }
+  else
+  {
+    out[0] = header(PACKED, count);
+    out[1] = width;
+    WireCodec::BitPacker packer(out + 2, width);
+    expected = 0;
+    while (this->next(idx))
+    {
+      packer.put(idx - expected);
+      expected = idx + 1;
+    }
+    packer.flush();
+    nbytes += packed_nbytes;
+  }
+
+  rewind();
+  return nbytes;
 }
 
 // Returns number of meaningful scanned bytes from blob.
@@ -54,8 +159,9 @@ uint32_t SerializableBitVector::deserialize_from(const void* blob, uint32_t sub_
     assert(this->count() == 0);
   assert(sub_size == this->size());
 
-  uint32_t* in = (uint32_t*) blob;
-  uint32_t tmp_count = in[0];
+  const uint32_t* in = (const uint32_t*) blob;
+  Codec codec = (Codec) (in[0] >> COUNT_NBITS);
+  uint32_t tmp_count = in[0] & ((1u << COUNT_NBITS) - 1);
   assert(tmp_count <= sub_size);
 
   /*
@@ -64,12 +170,13 @@ uint32_t SerializableBitVector::deserialize_from(const void* blob, uint32_t sub_
    *       That would mean, blob cannot be consumed multiple times..
    *       However, it can be Isent() multiple times still, which we may want to do.
    */
-  if (is_dense(tmp_count, sub_size))
+  if (codec == PLAIN and is_dense(tmp_count, sub_size))
   {
     assert(blob_nbytes(tmp_count, sub_size) == this->buffer_nbytes());
-    uint32_t nbytes = blob_nbytes(tmp_count, sub_size);
+    uint32_t nbytes = this->buffer_nbytes();
 
-    memcpy(this->buffer(), blob, nbytes);
+    memcpy(this->buffer(), in, nbytes);
+    this->mark(0, this->vector_nwords());
     assert(check(this->size()));
 
     *nnzs = tmp_count;
@@ -78,15 +185,114 @@ uint32_t SerializableBitVector::deserialize_from(const void* blob, uint32_t sub_
     return nbytes;
   }
 
-  rewind();
+  uint32_t nbytes;
 
-  uint32_t max = tmp_count + 1;
-  for (uint32_t i = 1; i < max; i++)
-    this->push(in[i]);
+  if (codec == RUNS)
+    nbytes = deserialize_runs_from(in, tmp_count, sub_size);
+  else
+    nbytes = deserialize_gaps_from(in, tmp_count, codec);
 
-  // We rely on push() to update the nnzs as we insert indices.
   assert(*nnzs == tmp_count);
   assert(check(this->size()));
 
-  return max * sizeof(uint32_t);
+  return nbytes;
+}
+
+uint32_t SerializableBitVector::deserialize_runs_from(const uint32_t* in, uint32_t count,
+                                                      uint32_t size)
+{
+  // Like PLAIN if dense, RUNS (used for dense bitvectors only) overwrites all the bits.
+  this->clear();
+
+  const uint8_t* begin = (const uint8_t*) in;
+  const uint8_t* ptr = (const uint8_t*) (in + 1);
+
+  uint32_t from = 0, length;
+  bool ones = false;
+
+  while (from < size)
+  {
+    ptr = WireCodec::get_varint(ptr, length);
+    if (ones)
+      fill_range(from, length);
+    from += length;
+    ones = not ones;
+  }
+
+  *nnzs = count;
+  rewind();
+
+  return (uint32_t) (ptr - begin);
+}
+
+uint32_t SerializableBitVector::deserialize_gaps_from(const uint32_t* in, uint32_t count,
+                                                      Codec codec)
+{
+  rewind();
+
+  // We rely on push() to update the nnzs as we insert indices.
+
+  if (codec == PLAIN)
+  {
+    uint32_t max = count + 1;
+    for (uint32_t i = 1; i < max; i++)
+      this->push(in[i]);
+    return max * sizeof(uint32_t);
+  }
+
+  uint32_t idx, gap, expected = 0;
+
+  if (codec == VARINT)
+  {
+    const uint8_t* ptr = (const uint8_t*) (in + 1);
+    for (uint32_t i = 0; i < count; i++)
+    {
+      ptr = WireCodec::get_varint(ptr, gap);
+      idx = expected + gap;
+      this->push(idx);
+      expected = idx + 1;
+    }
+    return (uint32_t) (ptr - (const uint8_t*) in);
+  }
+
+  assert(codec == PACKED);
+  uint32_t width = in[1];
+  WireCodec::BitUnpacker unpacker(in + 2, width);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    idx = expected + unpacker.get();
+    this->push(idx);
+    expected = idx + 1;
+  }
+  return (2 + WireCodec::packed_nwords(count, width)) * sizeof(uint32_t);
+}
+
+uint32_t SerializableBitVector::find_next(uint32_t from, bool ones) const
+{
+  uint32_t max = this->vector_nwords();
+  uint32_t flip = ones ? 0 : ~0u;
+
+  uint32_t x = from >> lg_bitwidth;
+  uint32_t word = (words[x] ^ flip) & (~0u << (from & bitwidth_mask));
+
+  while (word == 0 and ++x < max)
+    word = words[x] ^ flip;
+
+  if (word == 0)
+    return n;
+  return std::min(n, (x << lg_bitwidth) + __builtin_ctz(word));
+}
+
+void SerializableBitVector::fill_range(uint32_t from, uint32_t length)
+{
+  uint32_t to = from + length;
+
+  while (from < to)
+  {
+    uint32_t x = from >> lg_bitwidth, bit = from & bitwidth_mask;
+    uint32_t nbits = std::min(bitwidth - bit, to - from);
+    if (words[x] == 0) mark(x);
+    words[x] |= (nbits == bitwidth) ? ~0u : ((1u << nbits) - 1) << bit;
+    from += nbits;
+  }
 }
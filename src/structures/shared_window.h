@@ -0,0 +1,106 @@
+#ifndef SHARED_WINDOW_H
+#define SHARED_WINDOW_H
+
+#include <atomic>
+#include <cassert>
+#include <new>
+#include <vector>
+#include <mpi.h>
+#include "utils/env.h"
+
+
+/**
+ * Host-shared memory window, through which co-located ranks exchange (bound) segments.
+ *
+ * Each rank reserve()'s one slot per segment it sends to a co-located rank, then all ranks on
+ * the host allocate() the window together (collective over Env::MPI_NODE).
+ * The sender serializes straight into its slot, and the receiver deserializes straight from
+ * it (through its own mapping of the sender's part of the window). Only the slot's offset is
+ * sent over MPI, to notify the receiver and keep the request-based flow of the segments.
+ *
+ * A slot is busy from the moment its owner starts writing it until the receiver is done
+ * reading it; the owner waits (if needed) before writing the next round.
+ **/
+
+class SharedWindow
+{
+public:
+  /* Slots (and, hence, blobs) start at this alignment in every rank's mapping. */
+  static constexpr uint64_t ALIGNMENT = 64;
+
+  struct Slot
+  {
+    std::atomic<uint32_t> busy;
+
+    void* blob() { return (char*) this + ALIGNMENT; }
+  };
+
+private:
+  MPI_Win win = MPI_WIN_NULL;
+
+  char* base = nullptr;
+
+  std::vector<char*> peer_bases;  // by node rank
+
+  std::vector<uint64_t> offsets;  // of my slots
+
+  uint64_t nbytes = 0;
+
+public:
+
+  ~SharedWindow()
+  {
+    if (win != MPI_WIN_NULL)
+      MPI_Win_free(&win);
+  }
+
+  /** Is the given rank on my host (excluding myself, who is better off with MPI)? **/
+  static bool colocated(int32_t rank)
+  {
+    return rank != Env::rank and Env::node_rank_of(rank) >= 0;
+  }
+
+  /** Reserve a slot for a blob of (at most) blob_nbytes, and return its offset. **/
+  uint64_t reserve(uint32_t blob_nbytes)
+  {
+    assert(win == MPI_WIN_NULL);
+    uint64_t offset = nbytes;
+    nbytes += ALIGNMENT + (blob_nbytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    offsets.push_back(offset);
+    return offset;
+  }
+
+  /** Collective over all ranks on the host. **/
+  void allocate()
+  {
+    assert(win == MPI_WIN_NULL);
+
+    // Page-align every rank's part, so that slot alignment holds in every mapping.
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "alloc_shared_noncontig", "true");
+    MPI_Win_allocate_shared(nbytes, 1, info, Env::MPI_NODE, &base, &win);
+    MPI_Info_free(&info);
+
+    for (auto offset : offsets)
+      new (base + offset) Slot{{0}};
+
+    peer_bases.resize(Env::node_nranks);
+    for (int i = 0; i < Env::node_nranks; i++)
+    {
+      MPI_Aint size;
+      int disp_unit;
+      MPI_Win_shared_query(win, i, &size, &disp_unit, &peer_bases[i]);
+    }
+  }
+
+  Slot* local(uint64_t offset) { return (Slot*) (base + offset); }
+
+  Slot* peer(int32_t rank, uint64_t offset)
+  {
+    return (Slot*) (peer_bases[Env::node_rank_of(rank)] + offset);
+  }
+};
+
+
+#endif
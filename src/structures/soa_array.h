@@ -0,0 +1,275 @@
+#ifndef SOA_ARRAY_
+#define SOA_ARRAY_
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <boost/preprocessor/punctuation/comma_if.hpp>
+#include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/seq/for_each_i.hpp>
+#include "structures/random_access_array.h"
+
+
+/**
+ * Storage layout of vertex states S: how the engine stores them and how vertex programs see them.
+ *
+ * By default, states are stored as an array of structs (RandomAccessArray<S>), and a vertex
+ * program sees each as an S&.
+ *
+ * A state that declares its fields with SOA_STATE() is stored as a struct of arrays instead
+ * (SoAArray<S>): each field contiguously, so a pass that reads or writes one field of every
+ * vertex does not fetch the others. A vertex program then sees each state as a proxy, whose
+ * members are references to the vertex's fields (i.e., state.rank reads and writes as before).
+ * Override the interface with StateRef (resp. ConstStateRef) in place of S& (resp. const S&).
+ **/
+
+template <class S>
+struct StateLayout
+{
+  using Array    = RandomAccessArray<S>;
+  using Ref      = S&;
+  using ConstRef = const S&;
+};
+
+
+/**
+ * Array of vertex states stored as a struct of arrays (see StateLayout). Same interface as
+ * RandomAccessArray<S>, except that operator[] returns a proxy (StateLayout<S>::Ref).
+ * Only trivially-serializable states: on the wire, the active states are laid out as structs
+ * (as by RandomAccessArray), so mirrors and masters may use either layout.
+ **/
+
+template <class S>
+class SoAArray
+{
+public:
+  using Type = S;
+  using ActivitySet = Communicable<SerializableBitVector>;
+  using Columns = typename StateLayout<S>::Columns;
+  using Ref = typename StateLayout<S>::Ref;
+
+  static_assert(not std::is_base_of<Serializable, S>::value,
+                "SoA states must be trivially serializable.");
+
+  ActivitySet* activity;
+
+protected:
+  uint32_t n;
+
+  Columns cols;
+
+  MemoryCharge charge;  // (Under the allocating scope's category, see Memory.)
+
+public: /* Constructor(s), Destructor(s), and Random Access Operations. */
+
+  SoAArray() {}  // for FixedVector allocation
+
+  // A default-initialized array of size n.
+  SoAArray(uint32_t n) : activity(new ActivitySet(n)), n(n)
+  {
+    cols.allocate(n + 1);
+    charge.add((n + 1) * Columns::entry_nbytes());
+    cols.fill(n + 1, S());
+    rewind();
+  }
+
+  ~SoAArray()
+  {
+    cols.free();
+    delete activity;
+    activity = nullptr;
+  }
+
+  void temporarily_resize(uint32_t n_)
+  {
+    rewind();
+    activity->temporarily_resize(n_);
+    n = n_;
+  }
+
+  /** Move the fields' arrays to the out-of-core file, if large enough (see OutOfCore). **/
+  void spill() { cols.spill(n + 1); }
+
+  // Only touches the fields' arrays -- not the bitvector.
+  void fill(const S& val) { cols.fill(n, val); }
+
+  // Re-initializes the active entries only (see BitVector::clear()).
+  void clear() { activity->clear([this](uint32_t idx) { cols.store(idx, S()); }); }
+
+  Ref operator[](uint32_t idx) { return Ref(cols, idx); }
+
+  /* Exchange contents with an array of the same size (e.g., to deliver it without a copy). */
+  void swap(SoAArray& other)
+  {
+    assert(n == other.n);
+    std::swap(activity, other.activity);
+    cols.swap(other.cols);
+  }
+
+  uint32_t size() const { return n; }
+
+  /* Non-copyable. */
+  SoAArray(const SoAArray&) = delete;
+
+  const SoAArray& operator=(const SoAArray&) = delete;
+
+public: /* Sequential Access Operations. */
+
+  void rewind() { activity->rewind(); }
+
+  void push(uint32_t idx, const S& val)
+  {
+    activity->push(idx);
+    cols.store(idx, val);
+  }
+
+  bool pop(uint32_t& idx, S& val)
+  {
+    bool valid = activity->pop(idx);  // NOTE: idx may be one-past-end, but we allocate enough.
+    cols.load(idx, val);
+    cols.store(idx, S());  // "Zero" (i.e., re-initialize) the entry.
+    return valid;
+  }
+
+  bool next(uint32_t& idx, S& val)
+  {
+    bool valid = activity->next(idx);
+    cols.load(idx, val);
+    return valid;
+  }
+
+  template <bool destructive>
+  bool advance(uint32_t& idx, S& val)
+  {
+    if (destructive)
+      return pop(idx, val);
+    else
+      return next(idx, val);
+  }
+
+public:  /* Serialization Interface. */
+
+  template <bool destructive = false>
+  uint32_t serialize_into(void*& blob)
+  {
+    uint32_t values_nbytes = activity->count() * sizeof(S);  // Must be before serialize_into()
+    uint32_t activity_nbytes = activity->serialize_into<false /* NOT destructive! */>(blob);
+
+    S* values = blob_values_offset(blob, activity_nbytes, values_nbytes);
+
+    S val;
+    uint32_t idx, x = 0;
+
+    rewind();
+    while (this->advance<destructive>(idx, val))
+      values[x++] = val;
+    rewind();
+
+    return (char*) (values + x) - (char*) blob;
+  }
+
+  uint32_t deserialize_from(const void* blob)
+  {
+    uint32_t activity_nbytes = activity->deserialize_from(blob);
+    uint32_t values_nbytes = activity->count() * sizeof(S);  // Must be after deserialize_from()
+
+    S* values = blob_values_offset(blob, activity_nbytes, values_nbytes);
+
+    rewind();
+    uint32_t idx, x = 0;
+    while (activity->next(idx))
+      cols.store(idx, values[x++]);
+    rewind();
+
+    return (char*) (values + x) - (char*) blob;
+  }
+
+protected:  /* Serialization Implementation. */
+
+  void* new_blob(uint32_t nbytes) { return new char[nbytes]; }
+
+  void delete_blob(void* blob) { delete[] ((char*) blob); }
+
+  // Upper bound (due to max_padding rather than exact padding).
+  uint32_t blob_nbytes(uint32_t count)
+  {
+    return activity->blob_nbytes(count) + alignof(S) + count * sizeof(S);
+  }
+
+  uint32_t count() { return activity->count(); }
+
+private:
+  S* blob_values_offset(const void* blob, uint32_t activity_nbytes, uint32_t values_nbytes)
+  {
+    void* ptr = (char*) blob + activity_nbytes;
+    size_t space = SIZE_MAX;
+    S* retval = (S*) std::align(alignof(S), values_nbytes, ptr, space);
+    assert(retval);
+    return retval;
+  }
+};
+
+
+/**
+ * Store the states S as a struct of arrays: SOA_STATE(S, (field1)(field2)...), at namespace scope
+ * after S is defined. Every (data) field of S, including inherited ones, must be listed.
+ **/
+
+#define SOA_STATE(S, FIELDS)                                                              \
+  template <>                                                                             \
+  struct StateLayout<S>                                                                   \
+  {                                                                                       \
+    struct Columns                                                                        \
+    {                                                                                     \
+      BOOST_PP_SEQ_FOR_EACH(SOA_STATE_COLUMN_, S, FIELDS)                                 \
+      static constexpr size_t entry_nbytes()                                              \
+      { return 0 BOOST_PP_SEQ_FOR_EACH(SOA_STATE_SIZEOF_, S, FIELDS); }                   \
+      void allocate(uint32_t n) { BOOST_PP_SEQ_FOR_EACH(SOA_STATE_ALLOCATE_, S, FIELDS) } \
+      void free() { BOOST_PP_SEQ_FOR_EACH(SOA_STATE_FREE_, _, FIELDS) }                   \
+      void spill(uint32_t n) { BOOST_PP_SEQ_FOR_EACH(SOA_STATE_SPILL_, _, FIELDS) }        \
+      void swap(Columns& other) { BOOST_PP_SEQ_FOR_EACH(SOA_STATE_SWAP_, _, FIELDS) }     \
+      void fill(uint32_t n, const S& s) { BOOST_PP_SEQ_FOR_EACH(SOA_STATE_FILL_, _, FIELDS) } \
+      void load(uint32_t idx, S& s) const { BOOST_PP_SEQ_FOR_EACH(SOA_STATE_LOAD_, _, FIELDS) } \
+      void store(uint32_t idx, const S& s) { BOOST_PP_SEQ_FOR_EACH(SOA_STATE_STORE_, _, FIELDS) } \
+    };                                                                                    \
+                                                                                          \
+    struct Ref                                                                            \
+    {                                                                                     \
+      BOOST_PP_SEQ_FOR_EACH(SOA_STATE_REF_, S, FIELDS)                                    \
+      Ref(const Columns& cols, uint32_t idx)                                              \
+          : BOOST_PP_SEQ_FOR_EACH_I(SOA_STATE_BIND_COLUMN_, _, FIELDS) {}                 \
+      Ref(S& s) : BOOST_PP_SEQ_FOR_EACH_I(SOA_STATE_BIND_FIELD_, s, FIELDS) {}            \
+      operator S() const { S s; BOOST_PP_SEQ_FOR_EACH(SOA_STATE_GET_, _, FIELDS) return s; } \
+      std::string to_string() const { return S(*this).to_string(); }                      \
+    };                                                                                    \
+                                                                                          \
+    struct ConstRef                                                                       \
+    {                                                                                     \
+      BOOST_PP_SEQ_FOR_EACH(SOA_STATE_CONST_REF_, S, FIELDS)                              \
+      ConstRef(const Ref& r) : BOOST_PP_SEQ_FOR_EACH_I(SOA_STATE_BIND_FIELD_, r, FIELDS) {} \
+      ConstRef(const S& s) : BOOST_PP_SEQ_FOR_EACH_I(SOA_STATE_BIND_FIELD_, s, FIELDS) {} \
+      operator S() const { S s; BOOST_PP_SEQ_FOR_EACH(SOA_STATE_GET_, _, FIELDS) return s; } \
+      std::string to_string() const { return S(*this).to_string(); }                      \
+    };                                                                                    \
+                                                                                          \
+    using Array = SoAArray<S>;                                                            \
+  };
+
+// (Per-field helpers of SOA_STATE.)
+#define SOA_STATE_COLUMN_(r, S, f)        decltype(S::f)* f = nullptr;
+#define SOA_STATE_SIZEOF_(r, S, f)        + sizeof(decltype(S::f))
+#define SOA_STATE_ALLOCATE_(r, S, f)      f = new decltype(S::f)[n];
+#define SOA_STATE_FREE_(r, _, f)          OutOfCore::free_array(f); f = nullptr;
+#define SOA_STATE_SPILL_(r, _, f)         f = OutOfCore::spill_array(f, n);
+#define SOA_STATE_SWAP_(r, _, f)          std::swap(f, other.f);
+#define SOA_STATE_FILL_(r, _, f)          std::fill(f, f + n, s.f);
+#define SOA_STATE_LOAD_(r, _, f)          s.f = f[idx];
+#define SOA_STATE_STORE_(r, _, f)         f[idx] = s.f;
+#define SOA_STATE_REF_(r, S, f)           decltype(S::f)& f;
+#define SOA_STATE_CONST_REF_(r, S, f)     const decltype(S::f)& f;
+#define SOA_STATE_BIND_COLUMN_(r, _, i, f) BOOST_PP_COMMA_IF(i) f(cols.f[idx])
+#define SOA_STATE_BIND_FIELD_(r, obj, i, f) BOOST_PP_COMMA_IF(i) f(obj.f)
+#define SOA_STATE_GET_(r, _, f)           s.f = f;
+
+
+#endif
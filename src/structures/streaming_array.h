@@ -5,9 +5,11 @@
 #include <memory>
 #include <cstdint>
 #include <cstdlib>
+#include <type_traits>
 #include <utils/common.h>
 #include "structures/serializable_bitvector.h"
 #include "structures/communicable.h"
+#include "structures/wire_codec.h"
 
 
 template <class Value, class ActivitySet = Communicable<SerializableBitVector>>
@@ -18,6 +20,10 @@ public:
 
   ActivitySet* activity;
 
+  // Lossy on-the-wire codec for floating-point values (no effect on other types), which the
+  // sending and the receiving arrays must agree on (only a codec other than NONE is sent).
+  ValueCodec value_codec = ValueCodec::NONE;
+
 protected:
   uint32_t n;
 
@@ -27,6 +33,8 @@ protected:
 
   bool owns_vals = true;
 
+  MemoryCharge charge;  // (Under the allocating scope's category, see Memory.)
+
 public: /* Constructor(s), Destructor(s), and General Interface. */
 
   StreamingArray() {}  // for FixedVector allocation
@@ -36,6 +44,7 @@ public: /* Constructor(s), Destructor(s), and General Interface. */
       : activity(new ActivitySet(n)), n(n), vals(new Value[n + 1])
   {
     assert(vals);
+    charge.add((n + 1) * sizeof(Value));
     rewind();
   }
 
@@ -55,13 +64,17 @@ public: /* Constructor(s), Destructor(s), and General Interface. */
 
   // Copy constructor: shallow copy by default.
   StreamingArray(const StreamingArray &other, bool deep = false)
-      : activity(new ActivitySet(*other.activity, true /* shallow is buggy */)), n(other.n)
+      : activity(new ActivitySet(*other.activity, true /* shallow is buggy */)),
+        value_codec(other.value_codec), n(other.n)
   {
     owns_vals = deep;
     vals = deep ? (new Value[n + 1]) : other.vals;
     assert(vals);
     if (deep)
+    {
+      charge.add((n + 1) * sizeof(Value));
       memcpy(vals, other.vals, sizeof(Value) * (n + 1));
+    }
     rewind();
   }
 
@@ -81,6 +94,16 @@ public: /* Constructor(s), Destructor(s), and General Interface. */
     rewind();
   }
 
+  /* Exchange contents (but not value_codec) with an array of the same size, e.g., to deliver. */
+  void swap(StreamingArray& other)
+  {
+    assert(n == other.n);
+    std::swap(activity, other.activity);
+    std::swap(vals, other.vals);
+    std::swap(owns_vals, other.owns_vals);
+    std::swap(pos, other.pos);
+  }
+
 public: /* Sequential Access Operations. */
 
   void rewind()
@@ -116,19 +139,47 @@ public: /* Sequential Access Operations. */
       return next(idx, val);
   }
 
+public:  /* Read-only Sequential Access (any number of concurrent readers, no allocation). */
+
+  class Cursor
+  {
+    const Value* vals;
+
+    typename ActivitySet::Cursor bits;
+
+    uint32_t pos = 0;
+
+    uint32_t n;
+
+  public:
+    Cursor(const StreamingArray& array)
+        : vals(array.vals), bits(array.activity->cursor()), n(array.n) {}
+
+    bool next(uint32_t& idx, Value& val)
+    {
+      val = vals[pos++];
+      return bits.next(idx);
+    }
+
+    uint32_t size() const { return n; }
+  };
+
+  /** A fresh reader, from the start. The array must not be modified while it is in use. **/
+  Cursor cursor() const { return Cursor(*this); }
+
 public:  /* Serialization Interface. */
 
   template <bool destructive = false>
   uint32_t serialize_into(void*& blob);
 
-  void deserialize_from(const void* blob);
+  uint32_t deserialize_from(const void* blob);
 
-  void deserialize_from(const void* blob, uint32_t sub_size);
+  uint32_t deserialize_from(const void* blob, uint32_t sub_size);
 
   template <bool destructive = false>
   uint32_t serialize_into_dynamic(void*& blob);
 
-  void deserialize_from_dynamic(const void* blob, uint32_t sub_size);
+  uint32_t deserialize_from_dynamic(const void* blob, uint32_t sub_size);
 
 protected:  /* Serialization Implementation. */
 
@@ -136,19 +187,36 @@ protected:  /* Serialization Implementation. */
 
   void delete_blob(void* blob) { delete[] ((char*) blob); }
 
-  // Upper bound (due to max_padding rather than exact padding).
+  // Upper bound (due to max_padding rather than exact padding, and the codec's word even if
+  // NONE, i.e., not sent).
   uint32_t blob_nbytes(uint32_t count)
   {
     uint32_t activity_nbytes = activity->blob_nbytes(count);
+    uint32_t codec_nbytes = std::is_floating_point<Value>::value ? sizeof(uint32_t) : 0;
     uint32_t max_padding = alignof(Value);
     uint32_t values_nbytes = count * sizeof(Value);
-    return activity_nbytes + max_padding + values_nbytes;
+    return activity_nbytes + codec_nbytes + max_padding + values_nbytes;
   }
 
   uint32_t count() { return activity->count(); }
 
 private:  /* Further Serialization Implementation. */
   Value* blob_values_offset(const void* blob, uint32_t activity_nbytes, uint32_t values_nbytes);
+
+  // Dispatched on std::is_floating_point<Value>, as only then are values 16-bit encodable.
+  using IsFloat = typename std::is_floating_point<Value>::type;
+
+  template <bool destructive>
+  uint32_t serialize_values16_into(void* blob, uint32_t offset, std::true_type);
+
+  template <bool destructive>
+  uint32_t serialize_values16_into(void*, uint32_t, std::false_type) { assert(false); return 0; }
+
+  uint32_t deserialize_values16_from(const void* blob, uint32_t offset, ValueCodec codec,
+                                     std::true_type);
+
+  uint32_t deserialize_values16_from(const void*, uint32_t, ValueCodec, std::false_type)
+  { assert(false); return 0; }
 };
 
 
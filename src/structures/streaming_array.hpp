@@ -18,6 +18,17 @@ uint32_t StreamingArray<Value, ActivitySet>::serialize_into(void*& blob)
   uint32_t idx, x = 0;
 
   uint32_t activity_nbytes = activity->template serialize_into<false>(blob);  // Not destructive.
+
+  // Encoded floating-point values are preceded by their codec (possibly unaligned, hence memcpy).
+  if (std::is_floating_point<Value>::value and value_codec != ValueCodec::NONE)
+  {
+    uint32_t codec = value_codec;
+    memcpy((char*) blob + activity_nbytes, &codec, sizeof(uint32_t));
+    activity_nbytes += sizeof(uint32_t);
+
+    return serialize_values16_into<destructive>(blob, activity_nbytes, IsFloat());
+  }
+
   uint32_t values_nbytes = nactive * sizeof(Value);
 
   Value* values = blob_values_offset(blob, activity_nbytes, values_nbytes);
@@ -35,25 +46,34 @@ uint32_t StreamingArray<Value, ActivitySet>::serialize_into(void*& blob)
 }
 
 template <class Value, class ActivitySet>
-void StreamingArray<Value, ActivitySet>::deserialize_from(const void* blob)
+uint32_t StreamingArray<Value, ActivitySet>::deserialize_from(const void* blob)
 {
-  deserialize_from(blob, size());
+  return deserialize_from(blob, size());
 }
 
 template <class Value, class ActivitySet>
-void StreamingArray<Value, ActivitySet>::deserialize_from(const void* blob, uint32_t sub_size)
+uint32_t StreamingArray<Value, ActivitySet>::deserialize_from(const void* blob,
+                                                              uint32_t sub_size)
 {
   // "IF" this is determined statically, the compiler should optimize this branch away.
   if (std::is_base_of<Serializable, Value>::value)
-  {
-    deserialize_from_dynamic(blob, sub_size);
-    return;
-  }
+    return deserialize_from_dynamic(blob, sub_size);
 
   uint32_t activity_nbytes = activity->deserialize_from(blob, sub_size);
 
   uint32_t nactive = activity->count();  // Must be called after activity is deserialized.
 
+  // (The sender's value_codec must be this array's, see value_codec.)
+  if (std::is_floating_point<Value>::value and value_codec != ValueCodec::NONE)
+  {
+    uint32_t codec;
+    memcpy(&codec, (const char*) blob + activity_nbytes, sizeof(uint32_t));
+    activity_nbytes += sizeof(uint32_t);
+    assert(codec == value_codec);
+
+    return deserialize_values16_from(blob, activity_nbytes, ValueCodec(codec), IsFloat());
+  }
+
   uint32_t values_nbytes = nactive * sizeof(Value);
 
   Value* values = blob_values_offset(blob, activity_nbytes, values_nbytes);
@@ -61,6 +81,11 @@ void StreamingArray<Value, ActivitySet>::deserialize_from(const void* blob, uint
   memcpy(vals, values, nactive * sizeof(Value));
 
   rewind();
+
+  if (not std::is_same<Value, Empty>::value)
+    return (uint32_t) ((char*) (values + nactive) - (char*) blob);
+  else
+    return (uint32_t) ((char*) (values) - (char*) blob);
 }
 
 template <class Value, class ActivitySet>
@@ -76,6 +101,41 @@ Value* StreamingArray<Value, ActivitySet>::blob_values_offset(
   return retval;
 }
 
+/* Lossy (16-bit) floating-point values implementation. */
+
+template <class Value, class ActivitySet>
+template <bool destructive>
+uint32_t StreamingArray<Value, ActivitySet>::serialize_values16_into(void* blob, uint32_t offset,
+                                                                     std::true_type)
+{
+  uint16_t* values = (uint16_t*) ((char*) blob + offset + (offset & 1));
+
+  Value val;
+  uint32_t idx, x = 0;
+
+  rewind();
+  while (StreamingArray::template advance<destructive>(idx, val))
+    values[x++] = WireCodec::encode16((float) val, value_codec);
+  rewind();
+
+  return (uint32_t) ((char*) (values + x) - (char*) blob);
+}
+
+template <class Value, class ActivitySet>
+uint32_t StreamingArray<Value, ActivitySet>::deserialize_values16_from(
+    const void* blob, uint32_t offset, ValueCodec codec, std::true_type)
+{
+  const uint16_t* values = (const uint16_t*) ((const char*) blob + offset + (offset & 1));
+
+  uint32_t nactive = activity->count();
+  for (uint32_t x = 0; x < nactive; x++)
+    vals[x] = (Value) WireCodec::decode16(values[x], codec);
+
+  rewind();
+
+  return (uint32_t) ((const char*) (values + nactive) - (const char*) blob);
+}
+
 /* Dynamically-sized serialization implementation. */
 
 template <class Value, class ActivitySet>
@@ -90,8 +150,7 @@ uint32_t StreamingArray<Value, ActivitySet>::serialize_into_dynamic(void*& blob)
     blob = new char[activity_nbytes];
 
     // Serialize activity into blob (not destructive).
-    uint32_t activity_nbytes_ = activity->template serialize_into<false>(blob);
-    assert(activity_nbytes == activity_nbytes_);
+    activity_nbytes = activity->template serialize_into<false>(blob);  // At most the bound above.
 
     rewind();
 
@@ -100,8 +159,7 @@ uint32_t StreamingArray<Value, ActivitySet>::serialize_into_dynamic(void*& blob)
 
   // Serialize activity into temporary blob (not destructive).
   char* tmp_blob = new char[activity_nbytes];
-  uint32_t activity_nbytes_ = activity->template serialize_into<false>(tmp_blob);
-  assert(activity_nbytes == activity_nbytes_);
+  activity_nbytes = activity->template serialize_into<false>(tmp_blob);  // At most the bound above.
 
   // Serialize values into bytestrings.
   std::string* values = new std::string[nactive];
@@ -132,8 +190,10 @@ uint32_t StreamingArray<Value, ActivitySet>::serialize_into_dynamic(void*& blob)
   /* Format: (activity), (nactive * uint32_t (sizes)), (char * sizes[0]) ... (char * sizes[nactive-1]). */
 
   // Calculate blob size.
+  // (An encoded activity may take any nbytes: the sizes that follow are padded to alignment.)
+  uint32_t sizes_offset = (activity_nbytes + alignof(uint32_t) - 1) & ~(alignof(uint32_t) - 1);
   uint32_t sizes_nbytes = sizeof(uint32_t) * nactive;
-  uint32_t blob_nbytes = activity_nbytes + sizes_nbytes + values_nbytes;
+  uint32_t blob_nbytes = sizes_offset + sizes_nbytes + values_nbytes;
 
   // Allocate blob.
   blob = new char[blob_nbytes];
@@ -166,7 +226,7 @@ uint32_t StreamingArray<Value, ActivitySet>::serialize_into_dynamic(void*& blob)
 }
 
 template <class Value, class ActivitySet>
-void StreamingArray<Value, ActivitySet>::deserialize_from_dynamic(
+uint32_t StreamingArray<Value, ActivitySet>::deserialize_from_dynamic(
     const void* blob, uint32_t sub_size)
 {
   uint32_t activity_nbytes = activity->deserialize_from(blob, sub_size);
@@ -176,7 +236,7 @@ void StreamingArray<Value, ActivitySet>::deserialize_from_dynamic(
   if (nactive == 0)
   {
     rewind();
-    return;
+    return activity_nbytes;
   }
 
   /* Format: (activity), (nactive * uint32_t (sizes)), (char * sizes[0]) ... (char * sizes[nactive-1]). */
@@ -201,11 +261,13 @@ void StreamingArray<Value, ActivitySet>::deserialize_from_dynamic(
     stream<basic_array_source<char>> s(device);
     boost::archive::binary_iarchive ia(s);
     ia >> val;
-    vals[i] = val;
+    vals[i] = std::move(val);  // (Its payload, e.g., in the arena, is not copied.)
     values += sizes[i];
 
     values_nbytes += sizes[i];
   }
 
   rewind();
+
+  return (uint32_t) (values - (char*) blob);
 }
@@ -0,0 +1,221 @@
+#ifndef WIRE_CODEC_H
+#define WIRE_CODEC_H
+
+#include <cstdint>
+#include <cstring>
+#include "utils/enum.h"
+
+
+/**
+ * Building blocks of the (compressed) wire formats of blobs.
+ *
+ * Index codecs (see SerializableBitVector): variable-byte (LEB128-style) and fixed-width
+ * bit-packed integers, used for delta-coded index lists and run lengths.
+ * Value codecs (see StreamingArray): lossy float16 / bfloat16 for floating-point messages.
+ **/
+
+
+class ValueCodec : public Enum {
+public:
+  using Enum::Enum;
+  static constexpr int NONE     = 0;  // Default
+  static constexpr int FLOAT16  = 1;  // IEEE 754 half precision (5-bit exponent)
+  static constexpr int BFLOAT16 = 2;  // Truncated single precision (8-bit exponent)
+
+  ValueCodec(const char* name) : Enum(name_to_value(name, names(), 3)) {}
+
+  const char* name() const { return names()[value]; }
+
+private:
+  static const char* const* names()
+  {
+    static const char* const NAMES[] = {"none", "float16", "bfloat16"};
+    return NAMES;
+  }
+};
+
+
+struct WireCodec
+{
+  /* Variable-byte integers: 7 bits per byte, high bit set on all but the last byte. */
+
+  static uint32_t varint_nbytes(uint32_t x)
+  {
+    uint32_t nbits = 32 - __builtin_clz(x | 1);
+    return (nbits + 6) / 7;
+  }
+
+  static uint8_t* put_varint(uint8_t* out, uint32_t x)
+  {
+    while (x >= 0x80)
+    {
+      *out++ = (uint8_t) (x | 0x80);
+      x >>= 7;
+    }
+    *out++ = (uint8_t) x;
+    return out;
+  }
+
+  static const uint8_t* get_varint(const uint8_t* in, uint32_t& x)
+  {
+    x = 0;
+    for (uint32_t shift = 0; ; shift += 7)
+    {
+      uint8_t byte = *in++;
+      x |= (uint32_t) (byte & 0x7F) << shift;
+      if (byte < 0x80)
+        return in;
+    }
+  }
+
+  /* Bit-packed integers: each takes exactly `width` bits, LSB first, in 32-bit words. */
+
+  static uint32_t bitwidth(uint32_t max) { return max ? 32 - __builtin_clz(max) : 0; }
+
+  static uint32_t packed_nwords(uint32_t count, uint32_t width)
+  {
+    return (uint32_t) (((uint64_t) count * width + 31) / 32);
+  }
+
+  struct BitPacker
+  {
+    uint32_t* out;
+    uint32_t width;
+    uint64_t acc = 0;
+    uint32_t nbits = 0;
+
+    BitPacker(uint32_t* out, uint32_t width) : out(out), width(width) {}
+
+    void put(uint32_t x)
+    {
+      acc |= (uint64_t) x << nbits;
+      nbits += width;
+      if (nbits >= 32)
+      {
+        *out++ = (uint32_t) acc;
+        acc >>= 32;
+        nbits -= 32;
+      }
+    }
+
+    uint32_t* flush()
+    {
+      if (nbits > 0)
+        *out++ = (uint32_t) acc;
+      return out;
+    }
+  };
+
+  struct BitUnpacker
+  {
+    const uint32_t* in;
+    uint32_t width;
+    uint64_t acc = 0;
+    uint32_t nbits = 0;
+
+    BitUnpacker(const uint32_t* in, uint32_t width) : in(in), width(width) {}
+
+    uint32_t get()
+    {
+      if (nbits < width)
+      {
+        acc |= (uint64_t) *in++ << nbits;
+        nbits += 32;
+      }
+      uint32_t x = (uint32_t) (acc & ((1ull << width) - 1));
+      acc >>= width;
+      nbits -= width;
+      return x;
+    }
+  };
+
+  /* Lossy 16-bit floating-point values (round to nearest even). */
+
+  static uint16_t to_bfloat16(float f)
+  {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    if ((bits & 0x7FFFFFFF) > 0x7F800000)  // NaN: keep it a (quiet) NaN.
+      return (uint16_t) ((bits >> 16) | 0x40);
+    bits += 0x7FFF + ((bits >> 16) & 1);
+    return (uint16_t) (bits >> 16);
+  }
+
+  static float from_bfloat16(uint16_t h)
+  {
+    uint32_t bits = (uint32_t) h << 16;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+  }
+
+  static uint16_t to_float16(float f)
+  {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+
+    uint16_t sign = (uint16_t) ((bits >> 16) & 0x8000);
+    uint32_t abs = bits & 0x7FFFFFFF;
+
+    if (abs >= 0x7F800000)  // Inf or NaN
+      return sign | 0x7C00 | (abs > 0x7F800000 ? 0x200 : 0);
+    if (abs >= 0x477FF000)  // Rounds to beyond the largest half (65504).
+      return sign | 0x7C00;
+    if (abs < 0x38800000)  // Subnormal half (or zero).
+    {
+      if (abs < 0x33000000)  // Rounds to zero.
+        return sign;
+      uint32_t exp = abs >> 23;
+      uint32_t mant = (abs & 0x7FFFFF) | 0x800000;
+      uint32_t shift = 126 - exp;  // half = mant * 2^(exp - 126)
+      uint32_t half = mant >> shift;
+      uint32_t rest = mant & ((1u << shift) - 1);
+      uint32_t halfway = 1u << (shift - 1);
+      half += (rest > halfway) or (rest == halfway and (half & 1));
+      return sign | (uint16_t) half;
+    }
+
+    uint32_t half = ((abs >> 13) - (112 << 10));  // Rebias the exponent (127 - 15).
+    uint32_t rest = abs & 0x1FFF;
+    half += (rest > 0x1000) or (rest == 0x1000 and (half & 1));
+    return sign | (uint16_t) half;
+  }
+
+  static float from_float16(uint16_t h)
+  {
+    uint32_t sign = (uint32_t) (h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1F;
+    uint32_t mant = h & 0x3FF;
+    uint32_t bits;
+
+    if (exp == 0x1F)  // Inf or NaN
+      bits = sign | 0x7F800000 | (mant << 13);
+    else if (exp > 0)
+      bits = sign | ((exp + 112) << 23) | (mant << 13);
+    else if (mant == 0)
+      bits = sign;
+    else  // Subnormal half: normalize.
+    {
+      exp = 113;
+      while (not (mant & 0x400))
+      {
+        mant <<= 1;
+        exp--;
+      }
+      bits = sign | (exp << 23) | ((mant & 0x3FF) << 13);
+    }
+
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+  }
+
+  static uint16_t encode16(float f, ValueCodec codec)
+  { return codec == ValueCodec::FLOAT16 ? to_float16(f) : to_bfloat16(f); }
+
+  static float decode16(uint16_t h, ValueCodec codec)
+  { return codec == ValueCodec::FLOAT16 ? from_float16(h) : from_bfloat16(h); }
+};
+
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include <boost/serialization/level.hpp>
+#include "utils/common.h"
+#include "utils/memory.h"
+
+
+/**
+ * Per-thread arenas for the short-lived payloads of dynamic types: the vectors that messages and
+ * accumulators carry (see ArenaVector), as returned by gather(), grown by combine(), or
+ * deserialized. Allocating them is a bump of the thread's chunk, and freeing them is a decrement.
+ *
+ * A chunk counts its live allocations, which any thread may free. Once they all are, the chunk
+ * rewinds (if its owner still bumps through it) or is released (if retired, i.e., once full).
+ * Since the engine re-initializes its message and accumulator entries every iteration, a chunk
+ * rewinds at the iteration boundaries, without an explicit reset; a payload that outlives its
+ * iteration (e.g., a source message) only keeps its chunk from rewinding.
+ **/
+
+class Arena
+{
+public:
+  static constexpr size_t CHUNK_NBYTES = 1 << 16;  // (Also their alignment.)
+
+  static constexpr size_t MAX_NBYTES = CHUNK_NBYTES / 4;  // Larger ones are left to the heap.
+
+  static void* allocate(size_t nbytes, size_t alignment)
+  {
+    if (nbytes > MAX_NBYTES)
+      return ::operator new(nbytes);
+    return local().bump(nbytes, alignment);
+  }
+
+  static void deallocate(void* ptr, size_t nbytes)
+  {
+    if (nbytes > MAX_NBYTES)
+    {
+      ::operator delete(ptr);
+      return;
+    }
+    unref((Chunk*) ((uintptr_t) ptr & ~(uintptr_t) (CHUNK_NBYTES - 1)));
+  }
+
+private:
+  struct Chunk
+  {
+    std::atomic<uint32_t> nlive{1};  // allocations, plus one while its owner bumps through it
+  };
+
+  static constexpr size_t HEADER_NBYTES = 64;  // (The chunk, on its own cache line.)
+
+  class Local
+  {
+  public:
+    ~Local() { if (chunk) unref(chunk); }
+
+    void* bump(size_t nbytes, size_t alignment)
+    {
+      assert(alignment <= HEADER_NBYTES);
+      nbytes = std::max<size_t>(nbytes, 1);  // (Never at the end, i.e., past the chunk.)
+
+      if (chunk and chunk->nlive.load(std::memory_order_acquire) == 1)
+        pos = begin();  // All freed: rewind.
+
+      uintptr_t at = (pos + alignment - 1) & ~(uintptr_t) (alignment - 1);
+      if (chunk == nullptr or at + nbytes > end())
+      {
+        if (chunk) unref(chunk);  // Retire it.
+        chunk = new_chunk();
+        at = pos = begin();
+      }
+
+      chunk->nlive.fetch_add(1, std::memory_order_relaxed);
+      pos = at + nbytes;
+      return (void*) at;
+    }
+
+  private:
+    Chunk* chunk = nullptr;
+
+    uintptr_t pos = 0;
+
+    uintptr_t begin() const { return (uintptr_t) chunk + HEADER_NBYTES; }
+
+    uintptr_t end() const { return (uintptr_t) chunk + CHUNK_NBYTES; }
+  };
+
+  static Local& local()
+  {
+    static thread_local Local arena;
+    return arena;
+  }
+
+  static Chunk* new_chunk()
+  {
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, CHUNK_NBYTES, CHUNK_NBYTES) != 0)
+      throw std::bad_alloc();
+    Memory::allocated(MemoryCategory::ARENAS, CHUNK_NBYTES);
+    return new (ptr) Chunk();
+  }
+
+  static void unref(Chunk* chunk)
+  {
+    if (chunk->nlive.fetch_sub(1, std::memory_order_acq_rel) == 1)  // (Retired, and now empty.)
+    {
+      chunk->~Chunk();
+      free(chunk);
+      Memory::freed(MemoryCategory::ARENAS, CHUNK_NBYTES);
+    }
+  }
+};
+
+
+/** Allocator of the calling thread's arena (stateless: any instance frees any allocation). **/
+
+template <class T>
+struct ArenaAllocator
+{
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+  ArenaAllocator() {}
+
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U>&) {}
+
+  T* allocate(size_t n) { return (T*) Arena::allocate(n * sizeof(T), alignof(T)); }
+
+  void deallocate(T* ptr, size_t n) { Arena::deallocate(ptr, n * sizeof(T)); }
+
+  template <class U>
+  bool operator==(const ArenaAllocator<U>&) const { return true; }
+
+  template <class U>
+  bool operator!=(const ArenaAllocator<U>&) const { return false; }
+};
+
+
+/**
+ * A SerializableVector in the arenas: for message and accumulator types (M and A) only, whose
+ * values the engine frees every iteration. A state (S) holding one would pin its chunk.
+ **/
+
+template <class T>
+using ArenaVector = SerializableVector<T, ArenaAllocator<T>>;
+
+
+/* Serialized without class information, like a std::vector (of a primitive type), whose wire
+ * format it then shares. */
+
+namespace boost { namespace serialization {
+
+template <class T>
+struct implementation_level<std::vector<T, ArenaAllocator<T>>>
+{
+  typedef mpl::integral_c_tag tag;
+  typedef mpl::int_<object_serializable> type;
+  BOOST_STATIC_CONSTANT(int, value = object_serializable);
+};
+
+}}
+
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <algorithm>
+#include <cstdio>
+#include <dirent.h>
+#include <map>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "utils/common.h"
+#include "utils/env.h"
+#include "utils/memory.h"
+
+
+/**
+ * Checkpoints ($LA3_CKPT_DIR, see Env::ckpt_dir) of an execution (e.g., a call to
+ * VertexProgram::execute()): at the end of every Env::ckpt_every-th iteration, each rank adds
+ * blobs (e.g., its serialized segments) under keys, then writes them to its own file in that
+ * directory from a background thread, while the next iterations run. Only one write is in
+ * flight: the next checkpoint waits for it, which bounds both the memory and the stall.
+ *
+ * A file is written under a temporary name and then renamed, so it is either complete or absent.
+ * Each rank keeps its last two, since a rank may be one checkpoint ahead of another when they
+ * stop; with $LA3_RESUME, the latest iteration checkpointed by every rank is loaded instead
+ * (see latest()).
+ *
+ * The executions of a run are numbered in order, and checkpointed separately: a run resumes
+ * into the same execution, as long as the ones before it are executed again. An execution
+ * removes its checkpoints once complete.
+ **/
+
+class Checkpoint
+{
+public:
+  using Blobs = std::map<uint32_t, std::vector<char>>;  // by key
+
+  static bool enabled() { return not Env::ckpt_dir.empty(); }
+
+  Checkpoint() : id(next_id()++) {}
+
+  ~Checkpoint()
+  {
+    wait();
+    for (auto written_iter : written)
+      std::remove(path(written_iter).c_str());
+  }
+
+  /** Is the end of iteration iter (i.e., after iter iterations) to be checkpointed? **/
+  bool due(uint32_t iter) const { return iter > 0 and iter % Env::ckpt_every == 0; }
+
+  /** Start the checkpoint of iteration iter (waiting for the last one to be written). **/
+  void begin(uint32_t iter_)
+  {
+    wait();
+    iter = iter_;
+    building = true;
+  }
+
+  bool started() const { return building; }
+
+  /** Add a blob allocated with new char[] (e.g., by Communicable::serialize()); takes it over. **/
+  void add(uint32_t key, void* blob, uint32_t nbytes)
+  {
+    assert(building and pending.count(key) == 0);
+    pending[key] = {(char*) blob, nbytes};
+  }
+
+  /** Write the blobs added since begin(), in the background. **/
+  void commit()
+  {
+    assert(building);
+    building = false;
+    writer = std::thread(&Checkpoint::write, this, iter, std::move(pending));
+    pending.clear();
+  }
+
+  /** Drop the blobs added since begin() (e.g., once converged). **/
+  void abort()
+  {
+    for (auto& blob : pending)
+    {
+      Memory::freed_blob(blob.second.first);
+      delete[] blob.second.first;
+    }
+    pending.clear();
+    building = false;
+  }
+
+  /** Wait for the last checkpoint to be written, if any. **/
+  void wait()
+  {
+    if (writer.joinable())
+      writer.join();
+  }
+
+  /** The latest iteration checkpointed by every rank (in this execution), or 0 (collective). **/
+  uint32_t latest() const
+  {
+    std::vector<uint32_t> iters = list();
+    uint32_t bound = UINT32_MAX;
+
+    // The latest one of mine that no rank is behind of, unless one of them is missing it.
+    while (true)
+    {
+      uint32_t mine = 0, candidate;
+      for (auto iter_ : iters)
+        if (iter_ <= bound) mine = std::max(mine, iter_);
+      MPI_Allreduce(&mine, &candidate, 1, MPI_UINT32_T, MPI_MIN, Env::MPI_WORLD);
+
+      if (candidate == 0)
+        return 0;
+
+      int found = std::count(iters.begin(), iters.end(), candidate) > 0, everywhere;
+      MPI_Allreduce(&found, &everywhere, 1, MPI_INT, MPI_LAND, Env::MPI_WORLD);
+
+      if (everywhere)
+        return candidate;
+
+      bound = candidate - 1;
+    }
+  }
+
+  /** Load the blobs of this rank's checkpoint of iteration iter (see latest()). **/
+  Blobs load(uint32_t iter_)
+  {
+    wait();
+    written = list();  // (To be replaced by the next ones, as if written by this run.)
+
+    std::string filename = path(iter_);
+    FILE* file = fopen(filename.c_str(), "rb");
+
+    Header header;
+    bool valid = file and fread(&header, sizeof(Header), 1, file) == 1 and header.magic == MAGIC
+                 and header.nranks == (uint32_t) Env::nranks and header.iter == iter_;
+
+    Blobs blobs;
+    for (uint32_t b = 0; valid and b < header.nblobs; b++)
+    {
+      uint32_t meta[2];  // (key, nbytes)
+      valid = fread(meta, sizeof(meta), 1, file) == 1;
+      if (not valid)
+        break;
+      auto& blob = blobs[meta[0]];
+      blob.resize(meta[1]);
+      valid = fread(blob.data(), 1, meta[1], file) == meta[1];
+    }
+
+    if (file)
+      fclose(file);
+
+    if (not valid)
+    {
+      LOG.error("Unable to read checkpoint %s \n", filename.c_str());
+      Env::exit(1);
+    }
+
+    return blobs;
+  }
+
+private:
+  static constexpr uint64_t MAGIC = 0x54504b4333414cULL;  // "LA3CKPT"
+
+  struct Header
+  {
+    uint64_t magic;
+    uint32_t nranks;
+    uint32_t iter;
+    uint32_t nblobs;
+  };
+
+  using Pending = std::map<uint32_t, std::pair<char*, uint32_t>>;  // key -> (blob, nbytes)
+
+  const uint32_t id;  // of the execution
+
+  uint32_t iter = 0;  // of the checkpoint being built
+
+  bool building = false;
+
+  Pending pending;
+
+  std::thread writer;
+
+  std::vector<uint32_t> written;  // (By the writer, between waits.)
+
+  static uint32_t& next_id()
+  {
+    static uint32_t id = 0;
+    return id;
+  }
+
+  std::string path(uint32_t iter_) const
+  {
+    return Env::ckpt_dir + "/la3." + std::to_string(Env::rank) + "." + std::to_string(id) + "."
+           + std::to_string(iter_) + ".ckpt";
+  }
+
+  /* The iterations of this rank's checkpoints (of this execution) in the directory. */
+  std::vector<uint32_t> list() const
+  {
+    std::vector<uint32_t> iters;
+
+    DIR* dir = opendir(Env::ckpt_dir.c_str());
+    if (dir == nullptr)
+      return iters;
+
+    std::string prefix = "la3." + std::to_string(Env::rank) + "." + std::to_string(id) + ".";
+    while (struct dirent* entry = readdir(dir))
+    {
+      std::string name = entry->d_name;
+      if (name.compare(0, prefix.size(), prefix) != 0)
+        continue;
+
+      uint32_t iter_;
+      int nchars = 0;
+      if (sscanf(name.c_str() + prefix.size(), "%u.ckpt%n", &iter_, &nchars) == 1
+          and prefix.size() + nchars == name.size())
+        iters.push_back(iter_);
+    }
+    closedir(dir);
+
+    std::sort(iters.begin(), iters.end());
+    return iters;
+  }
+
+  /* (Background:) write, then free, the blobs; then remove all but the last two checkpoints. */
+  void write(uint32_t iter_, Pending blobs)
+  {
+    std::string filename = path(iter_);
+    std::string tmp_filename = filename + ".tmp";
+
+    FILE* file = fopen(tmp_filename.c_str(), "wb");
+
+    Header header = {MAGIC, (uint32_t) Env::nranks, iter_, (uint32_t) blobs.size()};
+    bool valid = file and fwrite(&header, sizeof(Header), 1, file) == 1;
+
+    for (auto& blob : blobs)
+    {
+      uint32_t meta[2] = {blob.first, blob.second.second};
+      valid = valid and fwrite(meta, sizeof(meta), 1, file) == 1
+              and fwrite(blob.second.first, 1, meta[1], file) == meta[1];
+      Memory::freed_blob(blob.second.first);
+      delete[] blob.second.first;
+    }
+
+    if (file)
+    {
+      valid = valid and fflush(file) == 0 and fsync(fileno(file)) == 0;
+      valid = fclose(file) == 0 and valid;
+    }
+
+    if (not valid or std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+    {
+      LOG.warn("Unable to write checkpoint %s \n", filename.c_str());
+      std::remove(tmp_filename.c_str());
+      return;
+    }
+
+    written.push_back(iter_);
+    while (written.size() > 2)
+    {
+      std::remove(path(written.front()).c_str());
+      written.erase(written.begin());
+    }
+  }
+};
+
+
+#endif
@@ -127,16 +127,24 @@ struct IntegerWrapper
 };
 
 
-template <class T>
-struct SerializableVector : std::vector<T>, Serializable
+/* Optionally with its own allocator (e.g., ArenaVector, see utils/arena.h). */
+template <class T, class Allocator = std::allocator<T>>
+struct SerializableVector : std::vector<T, Allocator>, Serializable
 {
+  using Base = std::vector<T, Allocator>;
+
   SerializableVector() {}
-  SerializableVector(size_t size) : std::vector<T>(size) {}
-  SerializableVector(const std::vector<T>& other) : std::vector<T>(other) {}
-  SerializableVector(const std::vector<T>&& other) : std::vector<T>(other) {}
+  SerializableVector(size_t size) : Base(size) {}
+  SerializableVector(const Base& other) : Base(other) {}
+  SerializableVector(const Base&& other) : Base(other) {}
+
+  // From a vector with another allocator (copied).
+  template <class OtherAllocator>
+  SerializableVector(const std::vector<T, OtherAllocator>& other)
+      : Base(other.begin(), other.end()) {}
 
   template <class Archive>
-  void serialize(Archive& archive, const uint32_t) { archive & *((std::vector<T>*) this); }
+  void serialize(Archive& archive, const uint32_t) { archive & *((Base*) this); }
 };
 
 
@@ -5,8 +5,11 @@
 #include <cassert>
 #include <sys/mman.h>
 #include <unordered_set>
+#include <vector>
 #include "utils/common.h"
 #include "utils/locator.h"
+#include "utils/memory.h"
+#include "utils/out_of_core.h"
 
 
 template <class Weight>
@@ -72,6 +75,19 @@ struct CSC
 
   Entry* entries;
 
+  /**
+   * Row bands (see split()): the entries of column i in band b are [bandptrs[b][i],
+   * bandptrs[b + 1][i]). A single band (i.e., the whole column) by default.
+   **/
+  uint32_t nbands = 1;
+
+  std::vector<uint32_t*> bandptrs;
+
+  /** Are the arrays in the out-of-core file (see spill())? **/
+  bool spilled = false;
+
+  MemoryCharge charge;
+
 
   CSC(uint32_t ncols, uint32_t rowgrp_offset, int32_t colgrp_offset,
       std::unordered_set<Triple<Weight>, EdgeHash>* triples,
@@ -90,6 +106,8 @@ struct CSC
     entries = (Entry*) mmap(nullptr, nentries * sizeof(Entry), PROT_READ | PROT_WRITE,
                             MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
     assert(entries != nullptr);
+    charge.add(MemoryCategory::TILES,
+               2 * (ncols + 1) * sizeof(uint32_t) + nentries * sizeof(Entry));
 
     for (auto& triple : *triples)
     {
@@ -127,6 +145,69 @@ struct CSC
     assert(colptrs[0] == 0);
     for (int i = 0; i < ncols; i++)
       assert(colptrs[i] <= colptrs[i + 1]);
+
+    bandptrs = {colptrs, colptrs + 1};
+  }
+
+  /**
+   * Split the rows into bands at the given bounds (from 0 up to at least the largest global_idx),
+   * so that threads may process disjoint bands of the same columns at once. Each inner bound
+   * takes another array of column pointers.
+   **/
+  void split(const std::vector<uint32_t>& bounds)
+  {
+    assert(nbands == 1 and bounds.size() >= 2);
+    nbands = bounds.size() - 1;
+
+    bandptrs.assign(nbands + 1, nullptr);
+    bandptrs.front() = colptrs;
+    bandptrs.back() = colptrs + 1;
+
+    for (uint32_t b = 1; b < nbands; b++)
+    {
+      bandptrs[b] = (uint32_t*) mmap(nullptr, ncols * sizeof(uint32_t), PROT_READ | PROT_WRITE,
+                                     MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+      assert(bandptrs[b] != MAP_FAILED);
+      charge.add(MemoryCategory::TILES, ncols * sizeof(uint32_t));
+
+      // (Entries are sorted by global_idx within each column.)
+      for (uint32_t i = 0; i < ncols; i++)
+        bandptrs[b][i] = std::lower_bound(entries + colptrs[i], entries + colptrs[i + 1],
+                                          bounds[b], idx_bound_compare) - entries;
+
+      if (spilled)
+        bandptrs[b] = spill_mapping(bandptrs[b], ncols);
+    }
+  }
+
+  /**
+   * Move the arrays to the out-of-core file (see OutOfCore), mapped back read-only: their pages
+   * are then read in as the tile is streamed through, and may be evicted in between.
+   **/
+  void spill()
+  {
+    assert(nbands == 1 and not spilled);
+    spilled = true;
+
+    colptrs = spill_mapping(colptrs, ncols + 1);
+    colidxs = spill_mapping(colidxs, ncols + 1);
+    entries = spill_mapping(entries, nentries);
+    OutOfCore::advise(entries, nentries * sizeof(Entry), MADV_SEQUENTIAL);
+
+    bandptrs = {colptrs, colptrs + 1};
+  }
+
+  /** If spilled, start reading the tile in ahead of a pass over it. **/
+  void prefetch() const
+  {
+    if (not spilled)
+      return;
+
+    OutOfCore::advise(colptrs, (ncols + 1) * sizeof(uint32_t), MADV_WILLNEED);
+    OutOfCore::advise(colidxs, (ncols + 1) * sizeof(uint32_t), MADV_WILLNEED);
+    OutOfCore::advise(entries, nentries * sizeof(Entry), MADV_WILLNEED);
+    for (uint32_t b = 1; b < nbands; b++)
+      OutOfCore::advise(bandptrs[b], ncols * sizeof(uint32_t), MADV_WILLNEED);
   }
 
   ~CSC()
@@ -137,12 +218,26 @@ struct CSC
     munmap(colptrs, (ncols + 1) * sizeof(uint32_t));
     munmap(colidxs, (ncols + 1) * sizeof(uint32_t));
     munmap(entries, nentries * sizeof(Entry));
+    for (uint32_t b = 1; b < nbands; b++)
+      munmap(bandptrs[b], ncols * sizeof(uint32_t));
   }
 
 private:
+  /* Copy an (anonymous) mapping of n values to the out-of-core file, and unmap it. */
+  template <class T>
+  static T* spill_mapping(T* array, size_t n)
+  {
+    T* mapped = (T*) OutOfCore::map(array, n * sizeof(T), false);
+    munmap(array, n * sizeof(T));
+    return mapped;
+  }
+
   static bool idx_compare(const Entry& a, const Entry& b)
   { return a.global_idx < b.global_idx; }
 
+  static bool idx_bound_compare(const Entry& a, uint32_t global_idx)
+  { return a.global_idx < global_idx; }
+
   static bool column_major_compare(const Triple<Weight>& a, const Triple<Weight>& b)
   { return (a.col < b.col) | ((a.col == b.col) & (a.row < b.row)); }
 
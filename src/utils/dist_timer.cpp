@@ -1,4 +1,208 @@
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <unordered_set>
 #include "utils/dist_timer.h"
 
 
 std::vector<DistTimer> DistTimer::all_timers;
+
+std::mutex DistTimer::all_timers_mutex;
+
+
+static std::mutex trace_mutex;  // (Of the buffers and the interned names.)
+
+
+const char* Trace::intern(const std::string& name)
+{
+  static std::unordered_set<std::string> names;
+  std::lock_guard<std::mutex> lock(trace_mutex);
+  return names.insert(name).first->c_str();
+}
+
+Trace::Buffer* Trace::new_buffer()
+{
+  std::lock_guard<std::mutex> lock(trace_mutex);
+  buffers().emplace_back(new Buffer());
+  return buffers().back().get();
+}
+
+std::vector<std::unique_ptr<Trace::Buffer>>& Trace::buffers()
+{
+  static std::vector<std::unique_ptr<Buffer>> all;
+  return all;
+}
+
+
+/* Gather a string of each rank to rank 0 (collective). */
+static std::vector<std::string> gather_strings(const std::string& mine)
+{
+  int nbytes = mine.size();
+  std::vector<int> all_nbytes(Env::nranks), offsets(Env::nranks + 1, 0);
+  MPI_Gather(&nbytes, 1, MPI_INT, all_nbytes.data(), 1, MPI_INT, 0, Env::MPI_WORLD);
+  std::partial_sum(all_nbytes.begin(), all_nbytes.end(), offsets.begin() + 1);
+
+  std::vector<char> all(Env::is_master ? offsets.back() : 0);
+  MPI_Gatherv(mine.data(), nbytes, MPI_CHAR, all.data(), all_nbytes.data(), offsets.data(),
+              MPI_CHAR, 0, Env::MPI_WORLD);
+
+  std::vector<std::string> strings;
+  if (Env::is_master)
+    for (int r = 0; r < Env::nranks; r++)
+      strings.emplace_back(all.data() + offsets[r], all_nbytes[r]);
+  return strings;
+}
+
+static std::string escape(const char* name)
+{
+  std::string str;
+  for (; *name; name++)
+  {
+    if (*name == '"' or *name == '\\') str += '\\';
+    str += *name;
+  }
+  return str;
+}
+
+
+void Trace::write()
+{
+  // Spans still open (e.g., of a timer never stopped) end now.
+  double end = now(), first = end, origin;
+  for (auto& buffer : buffers())
+    for (auto& span : buffer->spans)
+    {
+      if (span.end == 0) span.end = end;
+      first = std::min(first, span.start);
+    }
+  MPI_Allreduce(&first, &origin, 1, MPI_DOUBLE, MPI_MIN, Env::MPI_WORLD);
+
+  /* Events of this rank (Chrome trace format: complete events, in microseconds since origin). */
+
+  std::string events;
+  char event[512];
+
+  snprintf(event, sizeof(event), "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, "
+           "\"args\": {\"name\": \"rank %d\"}}", Env::rank, Env::rank);
+  events += event;
+
+  // Per phase, keyed by its path (the names of its enclosing spans, then its own, separated by
+  // tabs): (first start, count, total secs), summed over the threads.
+  struct Phase { double first; uint64_t count; double total; };
+  std::map<std::string, Phase> phases;
+  std::vector<std::string> paths;  // of the spans of a thread
+
+  for (uint32_t tid = 0; tid < buffers().size(); tid++)
+  {
+    snprintf(event, sizeof(event), ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, "
+             "\"tid\": %u, \"args\": {\"name\": \"thread %u\"}}", Env::rank, tid, tid);
+    events += event;
+
+    auto& spans = buffers()[tid]->spans;
+    paths.resize(spans.size());
+
+    for (uint32_t token = 0; token < spans.size(); token++)
+    {
+      auto& span = spans[token];
+      auto& path = paths[token];  // (A parent opens, hence comes, before its children.)
+      path = span.parent < 0 ? span.name : paths[span.parent] + '\t' + span.name;
+
+      snprintf(event, sizeof(event), ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": %d, "
+               "\"tid\": %u, \"ts\": %.3lf, \"dur\": %.3lf}", escape(span.name).c_str(),
+               Env::rank, tid, (span.start - origin) * 1e6, (span.end - span.start) * 1e6);
+      events += event;
+
+      auto it = phases.find(path);
+      if (it == phases.end())
+        phases[path] = {span.start, 1, span.end - span.start};
+      else
+      {
+        it->second.first = std::min(it->second.first, span.start);
+        it->second.count++;
+        it->second.total += span.end - span.start;
+      }
+    }
+  }
+
+  std::ostringstream summary;  // (A line per phase.)
+  summary.precision(17);
+  for (auto& phase : phases)
+    summary << phase.second.first - origin << " " << phase.second.count << " "
+            << phase.second.total << " " << phase.first << "\n";
+
+  std::vector<std::string> all_events = gather_strings(events);
+  std::vector<std::string> all_summaries = gather_strings(summary.str());
+
+  if (not Env::is_master)
+    return;
+
+  /* Write the trace. */
+
+  FILE* file = fopen(Env::trace_file.c_str(), "w");
+  bool valid = file and fputs("{\"traceEvents\": [\n", file) >= 0;
+  for (int r = 0; r < Env::nranks; r++)
+    valid = valid and fputs(r ? ",\n" : "", file) >= 0
+            and fputs(all_events[r].c_str(), file) >= 0;
+  valid = valid and fputs("\n], \"displayTimeUnit\": \"ms\"}\n", file) >= 0;
+  if (file)
+    valid = fclose(file) == 0 and valid;
+
+  if (valid)
+    LOG.info("Trace written to %s \n", Env::trace_file.c_str());
+  else
+    LOG.warn("Unable to write trace %s \n", Env::trace_file.c_str());
+
+  /* Summarize it: per phase (as a tree, siblings in order of first start), its time across the
+     ranks. */
+
+  struct Stats { double first; uint64_t count; std::vector<double> totals; };
+  std::map<std::string, Stats> stats;
+
+  for (int r = 0; r < Env::nranks; r++)
+  {
+    std::istringstream lines(all_summaries[r]);
+    Phase phase;
+    std::string path;
+    while (lines >> phase.first >> phase.count >> phase.total
+           and std::getline(lines.ignore(), path))
+    {
+      auto it = stats.find(path);
+      if (it == stats.end())
+        it = stats.emplace(path, Stats{phase.first, 0, std::vector<double>(Env::nranks)}).first;
+      it->second.first = std::min(it->second.first, phase.first);
+      it->second.count += phase.count;
+      it->second.totals[r] = phase.total;
+    }
+  }
+
+  // Sort key of a phase: the first starts of its ancestors, then its own (then, its path).
+  std::vector<std::pair<std::vector<double>, std::string>> ordered;
+  for (auto& phase : stats)
+  {
+    std::vector<double> firsts;
+    for (size_t end = 0; end != std::string::npos; end = phase.first.find('\t', end + 1))
+      if (end)
+        firsts.push_back(stats.at(phase.first.substr(0, end)).first);
+    firsts.push_back(phase.second.first);
+    ordered.emplace_back(firsts, phase.first);
+  }
+  std::sort(ordered.begin(), ordered.end());
+
+  for (auto& key : ordered)
+  {
+    const std::string& path = key.second;
+    auto& totals = stats.at(path).totals;
+    auto min = std::min_element(totals.begin(), totals.end());
+    auto max = std::max_element(totals.begin(), totals.end());
+    double avg = std::accumulate(totals.begin(), totals.end(), 0.0) / Env::nranks;
+
+    size_t depth = std::count(path.begin(), path.end(), '\t');
+    const char* name = path.c_str() + path.rfind('\t') + 1;  // (From 0, if top level.)
+
+    LOG.info("Trace %s<%s> stats: %.1lf calls, %lf secs on average (%lf [on %u] -> %lf [on %u]) "
+             "\n", std::string(2 * depth, ' ').c_str(), name,
+             (double) stats.at(path).count / Env::nranks, avg,
+             *min, std::distance(totals.begin(), min), *max, std::distance(totals.begin(), max));
+  }
+}
@@ -1,5 +1,6 @@
 /*
- * NOTE: Not thread-safe due to unprotected usage of static member!
+ * DistTimers may be started and stopped by any thread (each stops its own), and are also traced
+ * (see Trace).
  */
 
 #ifndef DIST_TIMER_H
@@ -8,12 +9,110 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <numeric>
 #include <math.h>
+#include <time.h>
 #include "utils/env.h"
 #include "utils/log.h"
 
 
+/**
+ * Trace of the engine's phases ($LA3_TRACE, see Env::trace_file): each thread records the spans
+ * it opens and closes (e.g., of a DistTimer or a TraceSpan), nested, in its own buffer. At the
+ * end, Env::finalize() gathers them to rank 0, which writes them to that file as a Chrome trace
+ * (JSON, which Perfetto also reads: a process per rank, a track per thread) and prints a summary
+ * of the time spent per phase (per rank, summed over its threads), where a phase is a span name
+ * along with those of the spans it is nested in (e.g., "Deserialization" within "SpMV").
+ **/
+
+class Trace
+{
+public:
+  static bool enabled() { return not Env::trace_file.empty(); }
+
+  /** Open a span of the calling thread, named name, which must outlive the trace (e.g., a literal
+      or intern()'ed). Returns its token, to close() it with. **/
+  static uint32_t open(const char* name)
+  {
+    Buffer& buffer = local();
+    int32_t parent = buffer.open.empty() ? -1 : (int32_t) buffer.open.back();
+    buffer.spans.push_back({name, now(), 0, parent});
+    buffer.open.push_back(buffer.spans.size() - 1);
+    return buffer.spans.size() - 1;
+  }
+
+  static void close(uint32_t token)
+  {
+    Buffer& buffer = local();
+    buffer.spans[token].end = now();
+    auto it = std::find(buffer.open.rbegin(), buffer.open.rend(), token);  // (Usually the last.)
+    if (it != buffer.open.rend())
+      buffer.open.erase(std::next(it).base());
+  }
+
+  /** A copy of name, for as long as the trace. **/
+  static const char* intern(const std::string& name);
+
+  /** Gather the spans of every thread to rank 0, which writes them (collective). **/
+  static void write();
+
+private:
+  struct Span
+  {
+    const char* name;
+    double start;
+    double end;
+    int32_t parent;  // (Token of the innermost span open at its start, if any, else -1.)
+  };
+
+  struct Buffer
+  {
+    std::vector<Span> spans;
+    std::vector<uint32_t> open;  // (Tokens.)
+  };
+
+  static Buffer& local()
+  {
+    static thread_local Buffer* buffer = new_buffer();
+    return *buffer;
+  }
+
+  static Buffer* new_buffer();  // (Kept until write(), past the thread's end.)
+
+  static std::vector<std::unique_ptr<Buffer>>& buffers();  // of every thread, by id
+
+  static double now()
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);  // (Finer than Env::now(), on the same clock.)
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+  }
+};
+
+
+/** A span of the trace over a scope (a no-op unless tracing). **/
+
+class TraceSpan
+{
+public:
+  TraceSpan(const char* name) : token(Trace::enabled() ? Trace::open(name) : NONE) {}
+
+  ~TraceSpan() { if (token != NONE) Trace::close(token); }
+
+  TraceSpan(const TraceSpan&) = delete;
+
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  const uint32_t token;
+};
+
+
 class DistTimer
 {
 public:
@@ -30,14 +129,27 @@ public:
 
   DistTimer(std::string name) : name(name), start(Env::now())
   {
-    pos = all_timers.size();
-    all_timers.push_back(DistTimer(name, start));
+    {
+      std::lock_guard<std::mutex> lock(all_timers_mutex);
+      pos = all_timers.size();
+      all_timers.push_back(DistTimer(name, start));
+    }
+
+    if (Trace::enabled())
+      span = Trace::open(Trace::intern(name));
   }
 
   void stop()
   {
     elapsed = Env::now() - start;
-    all_timers[pos].elapsed = elapsed;
+    {
+      std::lock_guard<std::mutex> lock(all_timers_mutex);
+      all_timers[pos].elapsed = elapsed;
+    }
+
+    if (span != NO_SPAN)
+      Trace::close(span);
+    span = NO_SPAN;
   }
 
   double report(bool print = true)
@@ -66,6 +178,10 @@ private:
       : name(name), start(start) {}
 
 private:
+  static constexpr uint32_t NO_SPAN = UINT32_MAX;
+
+  static std::mutex all_timers_mutex;
+
   std::string name;
 
   double start;
@@ -73,6 +189,8 @@ private:
   double elapsed;
 
   uint64_t pos;
+
+  uint32_t span = NO_SPAN;  // (Its token in the trace, until stopped.)
 };
 
 
@@ -1,10 +1,12 @@
 #include <sys/time.h>
+#include <cstdlib>
 #include <vector>
 #include <numeric>
 #include <algorithm>
 #include <cassert>
 #include <atomic>
 #include "utils/env.h"
+#include "utils/dist_timer.h"
 
 
 int Env::rank  ;  // my rank
@@ -13,15 +15,48 @@ int Env::nranks;  // num of ranks
 
 std::atomic_size_t Env::nbytes_sent;
 
+std::atomic_size_t Env::nbytes_recvd;
+
+std::atomic_size_t Env::nmsgs_sent;
+
+bool Env::thread_multiple;
+
+CommBackend Env::backend;
+
+bool Env::progress_thread;
+
+uint32_t Env::row_bands;
+
+std::string Env::ooc_dir;
+
+std::string Env::ckpt_dir;
+
+uint32_t Env::ckpt_every;
+
+bool Env::resume;
+
+std::string Env::trace_file;
+
+std::string Env::stats_file;
+
 bool Env::is_master;  // rank == 0?
 
 MPI_Comm Env::MPI_WORLD;
 
+MPI_Comm Env::MPI_NODE;
+
+int Env::node_rank;
+
+int Env::node_nranks;
+
+std::vector<int> Env::node_ranks;
+
 
 void Env::init(RankOrder order)
 {
   int mpi_threading;
   MPI_Init_thread(0, nullptr, MPI_THREAD_MULTIPLE, &mpi_threading);
+  thread_multiple = mpi_threading == MPI_THREAD_MULTIPLE;
 
   /* Set Environment Variables. */
   MPI_Comm_size(MPI_COMM_WORLD, &nranks);
@@ -29,18 +64,56 @@ void Env::init(RankOrder order)
   is_master = rank == 0;
 
   nbytes_sent = 0;
+  nbytes_recvd = 0;
+  nmsgs_sent = 0;
+
+  const char* backend_name = std::getenv("LA3_BACKEND");
+  if (backend_name)
+    backend = CommBackend(backend_name);
+  else
+    backend = CommBackend(nranks == 1 ? CommBackend::LOCAL : CommBackend::POINT_TO_POINT);
+
+  const char* progress_str = std::getenv("LA3_PROGRESS");
+  progress_thread = progress_str and atoi(progress_str) != 0;
+
+  const char* row_bands_str = std::getenv("LA3_ROW_BANDS");
+  row_bands = row_bands_str ? std::max(0, atoi(row_bands_str)) : 0;
+
+  const char* ooc_dir_str = std::getenv("LA3_OOC_DIR");
+  ooc_dir = ooc_dir_str ? ooc_dir_str : "";
+
+  const char* ckpt_dir_str = std::getenv("LA3_CKPT_DIR");
+  ckpt_dir = ckpt_dir_str ? ckpt_dir_str : "";
+
+  const char* ckpt_every_str = std::getenv("LA3_CKPT_EVERY");
+  ckpt_every = ckpt_every_str ? std::max(1, atoi(ckpt_every_str)) : 10;
+
+  const char* resume_str = std::getenv("LA3_RESUME");
+  resume = resume_str and atoi(resume_str) != 0;
+
+  const char* trace_file_str = std::getenv("LA3_TRACE");
+  trace_file = trace_file_str ? trace_file_str : "";
+
+  const char* stats_file_str = std::getenv("LA3_STATS");
+  stats_file = stats_file_str ? stats_file_str : "";
 
   MPI_WORLD = MPI_COMM_WORLD;
   if (order != RankOrder::KEEP_ORIGINAL)
     shuffle_ranks(order);
+
+  split_node();
 }
 
 void Env::finalize()
-{ MPI_Finalize(); }
+{
+  if (Trace::enabled())
+    Trace::write();
+  MPI_Finalize();
+}
 
-void Env::exit(int code)
+void Env::exit(int code)  // (Not traced: other ranks may not be exiting.)
 {
-  finalize();
+  MPI_Finalize();
   std::exit(code);
 }
 
@@ -82,6 +155,28 @@ void Env::shuffle_ranks(RankOrder order)
 }
 
 
+void Env::split_node()
+{
+  MPI_Comm_split_type(MPI_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &MPI_NODE);
+  MPI_Comm_size(MPI_NODE, &node_nranks);
+  MPI_Comm_rank(MPI_NODE, &node_rank);
+
+  std::vector<int> world_ranks(node_nranks);
+  MPI_Allgather(&rank, 1, MPI_INT, world_ranks.data(), 1, MPI_INT, MPI_NODE);
+
+  node_ranks.assign(nranks, -1);
+  for (int i = 0; i < node_nranks; i++)
+    node_ranks[world_ranks[i]] = i;
+}
+
+
+void Env::progress()
+{
+  int flag;
+  MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_WORLD, &flag, MPI_STATUS_IGNORE);
+}
+
+
 double Env::now()
 {
   struct timeval tv;
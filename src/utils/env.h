@@ -2,6 +2,8 @@
 #define ENV_H
 
 #include <atomic>
+#include <string>
+#include <vector>
 #include <mpi.h>
 #include "utils/enum.h"
 
@@ -15,6 +17,26 @@ public:
 };
 
 
+class CommBackend : public Enum {
+public:
+  using Enum::Enum;
+  static constexpr int POINT_TO_POINT = 0;  // Default
+  static constexpr int NEIGHBORHOOD   = 1;  // MPI neighborhood collectives (see NeighborExchange)
+  static constexpr int LOCAL          = 2;  // Point-to-point, but in place to self (see LocalMailbox)
+
+  CommBackend(const char* name) : Enum(name_to_value(name, names(), 3)) {}
+
+  const char* name() const { return names()[value]; }
+
+private:
+  static const char* const* names()
+  {
+    static const char* const NAMES[] = {"p2p", "neighborhood", "local"};
+    return NAMES;
+  }
+};
+
+
 class Env
 {
 public:
@@ -29,8 +51,38 @@ public:
 
   static MPI_Comm MPI_WORLD;
 
+  static MPI_Comm MPI_NODE;  // ranks on my host (that can share memory)
+
+  static int node_rank;    // my rank in MPI_NODE
+
+  static int node_nranks;  // num of ranks on my host
+
   static std::atomic_size_t nbytes_sent;
 
+  static std::atomic_size_t nbytes_recvd;  // from other ranks, as deserialized (or read in place)
+
+  static std::atomic_size_t nmsgs_sent;  // message entries, to other ranks (see IterationStats)
+
+  static bool thread_multiple;  // does MPI allow concurrent calls from any thread?
+
+  static CommBackend backend;  // default of vertex programs ($LA3_BACKEND, else local if 1 rank)
+
+  static bool progress_thread;  // default of vertex programs ($LA3_PROGRESS, see ProgressEngine)
+
+  static uint32_t row_bands;  // per local rowgroup ($LA3_ROW_BANDS, else 0: by thread count)
+
+  static std::string ooc_dir;  // of the out-of-core file, if any ($LA3_OOC_DIR, see OutOfCore)
+
+  static std::string ckpt_dir;  // of the checkpoints, if any ($LA3_CKPT_DIR, see Checkpoint)
+
+  static uint32_t ckpt_every;  // iterations between checkpoints ($LA3_CKPT_EVERY, else 10)
+
+  static bool resume;  // from the last checkpoint ($LA3_RESUME)
+
+  static std::string trace_file;  // of the trace, if any ($LA3_TRACE, see Trace)
+
+  static std::string stats_file;  // of the iteration stats, if any ($LA3_STATS, see IterationStats)
+
   static void init(RankOrder order = RankOrder::FIXED_SHUFFLE);
 
   static void finalize();
@@ -43,8 +95,17 @@ public:
 
   static size_t get_global_comm_nbytes();
 
+  /** Rank in MPI_NODE of the given rank (in MPI_WORLD), or -1 if it is on another host. **/
+  static int node_rank_of(int rank) { return node_ranks[rank]; }
+
+  static void progress();  // drive MPI progress (e.g., while spinning)
+
 private:
+  static std::vector<int> node_ranks;
+
   static void shuffle_ranks(RankOrder order);
+
+  static void split_node();
 };
 
 
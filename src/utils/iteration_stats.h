@@ -0,0 +1,219 @@
+#ifndef ITERATION_STATS_H
+#define ITERATION_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "utils/enum.h"
+#include "utils/env.h"
+#include "utils/log.h"
+
+
+class IterationStat : public Enum {
+public:
+  using Enum::Enum;
+  static constexpr int SCATTERED        = 0;  // Vertices that scattered (i.e., messages produced)
+  static constexpr int MESSAGES         = 1;  // Messages sent to other ranks
+  static constexpr int EDGES            = 2;  // Edges traversed (i.e., gathered) by SpMV
+  static constexpr int COMBINED         = 3;  // Partial accumulators combined into final ones
+  static constexpr int ACTIVATED        = 4;  // Vertices activated by apply()
+  static constexpr int MIRRORS_BYTES    = 5;  // Bytes sent refreshing the mirrors
+  static constexpr int PROCESSING_BYTES = 6;  // Bytes sent processing messages (i.e., partials)
+  static constexpr int PRODUCING_BYTES  = 7;  // Bytes sent producing messages
+  static constexpr int MIRRORS_RECVD    = 8;  // Bytes recv'd refreshing the mirrors
+  static constexpr int PROCESSING_RECVD = 9;  // Bytes recv'd processing messages (i.e., messages)
+  static constexpr int PRODUCING_RECVD  = 10;  // Bytes recv'd producing messages (i.e., partials)
+  static constexpr int COUNT            = 11;
+
+  const char* name() const { return names()[value]; }
+
+  /* Reported per rank too (min and max), as these expose communication imbalance. */
+  bool per_rank() const { return value == MESSAGES or value >= MIRRORS_BYTES; }
+
+private:
+  static const char* const* names()
+  {
+    static const char* const NAMES[] = {"scattered", "messages", "edges", "combined", "activated",
+                                        "mirrors_bytes", "processing_bytes", "producing_bytes",
+                                        "mirrors_recvd_bytes", "processing_recvd_bytes",
+                                        "producing_recvd_bytes"};
+    return NAMES;
+  }
+};
+
+
+/**
+ * Counters of the work done by every iteration of an execution, on this rank: any thread may
+ * add() to those of the current one (between begin() and end()). Messages are counted as sent by
+ * Env::nmsgs_sent, and bytes as by Env::nbytes_sent and Env::nbytes_recvd, charged to a phase
+ * once it ends (exchanged()).
+ *
+ * If $LA3_STATS names a file (see Env::stats_file), report() sums them over the ranks, appends a
+ * row per iteration to it (CSV, with the iteration's time on the slowest rank and its TEPS, i.e.,
+ * edges traversed per second, and the min and max over the ranks of the message and byte
+ * counters), and prints the totals.
+ **/
+
+class IterationStats
+{
+public:
+  static bool enabled() { return not Env::stats_file.empty(); }
+
+  void begin(uint32_t iter_)
+  {
+    iter = iter_;
+    for (auto& counter : current)
+      counter = 0;
+    nmsgs_mark = Env::nmsgs_sent;
+    nbytes_mark = Env::nbytes_sent;
+    nbytes_recvd_mark = Env::nbytes_recvd;
+    start = Env::now();
+  }
+
+  void add(IterationStat stat, uint64_t n)
+  { current[stat].fetch_add(n, std::memory_order_relaxed); }
+
+  /** Charge the bytes sent and recv'd since the last phase (or begin()) to sent and recvd. **/
+  void exchanged(IterationStat sent, IterationStat recvd)
+  {
+    size_t nbytes = Env::nbytes_sent;
+    add(sent, nbytes - nbytes_mark);
+    nbytes_mark = nbytes;
+
+    nbytes = Env::nbytes_recvd;
+    add(recvd, nbytes - nbytes_recvd_mark);
+    nbytes_recvd_mark = nbytes;
+  }
+
+  void end()
+  {
+    add(IterationStat::MESSAGES, Env::nmsgs_sent - nmsgs_mark);
+    for (auto& counter : current)
+      counters.push_back(counter);
+    secs.push_back(Env::now() - start);
+    iters.push_back(iter);
+  }
+
+  /** Reduce and report the iterations since the last report(), if enabled (collective). **/
+  void report()
+  {
+    if (enabled())
+      write();
+    counters.clear();
+    secs.clear();
+    iters.clear();
+  }
+
+private:
+  std::atomic<uint64_t> current[IterationStat::COUNT] = {};
+
+  size_t nmsgs_mark = 0, nbytes_mark = 0, nbytes_recvd_mark = 0;
+
+  uint32_t iter = 0;
+
+  double start = 0;
+
+  std::vector<uint64_t> counters;  // per iteration, per stat
+
+  std::vector<double> secs;  // per iteration
+
+  std::vector<uint32_t> iters;  // (From 0, or from the one resumed from.)
+
+  static uint32_t& next_execution()
+  {
+    static uint32_t execution = 0;
+    return execution;
+  }
+
+  void write()
+  {
+    uint32_t execution = next_execution()++;
+
+    uint32_t niters = secs.size();  // (The same on every rank.)
+    if (niters == 0)
+      return;
+
+    // Then, the totals of this rank: per stat, and of the bytes sent and recv'd.
+    uint32_t offset = niters * IterationStat::COUNT;
+    counters.resize(offset + IterationStat::COUNT + 2);
+    for (uint32_t i = 0; i < niters; i++)
+      for (int s = 0; s < IterationStat::COUNT; s++)
+        counters[offset + s] += counters[i * IterationStat::COUNT + s];
+    for (int s = IterationStat::MIRRORS_BYTES; s < IterationStat::COUNT; s++)
+      counters[offset + IterationStat::COUNT + (s >= IterationStat::MIRRORS_RECVD)]
+          += counters[offset + s];
+
+    std::vector<uint64_t> all_counters(counters.size());
+    std::vector<uint64_t> mins(counters.size()), maxes(counters.size());  // over the ranks
+    std::vector<double> all_secs(niters);
+    MPI_Reduce(counters.data(), all_counters.data(), counters.size(), MPI_UINT64_T, MPI_SUM, 0,
+               Env::MPI_WORLD);
+    MPI_Reduce(counters.data(), mins.data(), counters.size(), MPI_UINT64_T, MPI_MIN, 0,
+               Env::MPI_WORLD);
+    MPI_Reduce(counters.data(), maxes.data(), counters.size(), MPI_UINT64_T, MPI_MAX, 0,
+               Env::MPI_WORLD);
+    MPI_Reduce(secs.data(), all_secs.data(), niters, MPI_DOUBLE, MPI_MAX, 0, Env::MPI_WORLD);
+
+    if (not Env::is_master)
+      return;
+
+    FILE* file = fopen(Env::stats_file.c_str(), "a");
+    bool valid = file != nullptr;
+
+    if (valid and ftell(file) == 0)  // (New: header first.)
+    {
+      fprintf(file, "execution,iteration,secs");
+      for (int s = 0; s < IterationStat::COUNT; s++)
+      {
+        IterationStat stat(s);
+        fprintf(file, ",%s", stat.name());
+        if (stat.per_rank())
+          fprintf(file, ",%s_min,%s_max", stat.name(), stat.name());
+      }
+      fprintf(file, ",teps\n");
+    }
+
+    double total_secs = 0;
+
+    for (uint32_t i = 0; i < niters; i++)
+    {
+      uint32_t first = i * IterationStat::COUNT;
+      const uint64_t* stats = &all_counters[first];
+      total_secs += all_secs[i];
+
+      if (not valid)
+        continue;
+
+      fprintf(file, "%u,%u,%lf", execution, iters[i] + 1, all_secs[i]);
+      for (int s = 0; s < IterationStat::COUNT; s++)
+      {
+        fprintf(file, ",%lu", stats[s]);
+        if (IterationStat(s).per_rank())
+          fprintf(file, ",%lu,%lu", mins[first + s], maxes[first + s]);
+      }
+      fprintf(file, ",%.0lf\n", all_secs[i] > 0 ? stats[IterationStat::EDGES] / all_secs[i] : 0.0);
+    }
+
+    if (file)
+      valid = fclose(file) == 0 and valid;
+    if (not valid)
+      LOG.warn("Unable to write stats to %s \n", Env::stats_file.c_str());
+
+    const uint64_t* totals = &all_counters[offset];
+    const uint32_t MESSAGES = offset + IterationStat::MESSAGES;
+    const uint32_t SENT = offset + IterationStat::COUNT, RECVD = SENT + 1;
+
+    LOG.info("Stats: %u iterations, %lu edges traversed in %lf secs (%.0lf TEPS), %lu vertices "
+             "activated \n", niters, totals[IterationStat::EDGES], total_secs,
+             total_secs > 0 ? totals[IterationStat::EDGES] / total_secs : 0.0,
+             totals[IterationStat::ACTIVATED]);
+    LOG.info("Stats: %lu messages sent (%lu to %lu per rank), %lu bytes sent (%lu to %lu), %lu "
+             "bytes recv'd (%lu to %lu) \n", all_counters[MESSAGES], mins[MESSAGES],
+             maxes[MESSAGES], all_counters[SENT], mins[SENT], maxes[SENT], all_counters[RECVD],
+             mins[RECVD], maxes[RECVD]);
+  }
+};
+
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef LANE_SCHEDULER_H
+#define LANE_SCHEDULER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+/**
+ * Scheduler of weighted tasks over lanes, run by a team of threads (e.g., an OpenMP team).
+ *
+ * Tasks of the same lane (e.g., that accumulate into the same segment) run one at a time, in the
+ * order they were added; tasks of different lanes run concurrently. An idle thread takes on the
+ * lane with the most pending weight (e.g., nnz) that no other thread is on.
+ *
+ * Tasks may keep arriving while the threads work: whenever none is runnable, one thread at a
+ * time calls feed() to add more (e.g., as segments are received), blocking if it must, until
+ * feed() returns false (nothing more to come). There is no barrier between two feeds.
+ *
+ * Optionally, one thread at a time also calls poll() between tasks, to add any that arrived
+ * (or to make other progress) without waiting for the runnable ones to run out. poll() must
+ * not block.
+ **/
+
+class LaneScheduler
+{
+public:
+  using Task = std::function<void()>;
+
+private:
+  struct Lane
+  {
+    std::deque<std::pair<uint64_t, Task>> tasks;  // (weight, task)
+    uint64_t weight = 0;  // of the pending tasks
+    bool busy = false;
+  };
+
+  std::vector<Lane> lanes;
+
+  uint32_t npending = 0;
+
+  bool feeding = false;  // Some thread is in feed().
+
+  bool fed = false;  // No more tasks to come.
+
+  std::mutex mutex;
+
+  std::condition_variable changed;
+
+public:
+
+  /** Start over, with the given number of lanes (by a single thread, before run()). **/
+  void reset(uint32_t nlanes)
+  {
+    lanes.clear();
+    lanes.resize(nlanes);
+    npending = 0;
+    feeding = fed = false;
+  }
+
+  void add(uint32_t lane, uint64_t weight, Task task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      lanes[lane].tasks.emplace_back(weight, std::move(task));
+      lanes[lane].weight += weight;
+      npending++;
+    }
+    changed.notify_one();
+  }
+
+  /** Called by every thread of the team. Returns once all tasks are done or taken. **/
+  template <class Feed>
+  void run(Feed feed) { run(feed, []() {}, false); }
+
+  template <class Feed, class Poll>
+  void run(Feed feed, Poll poll, bool polling = true)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+      if (polling and not fed and not feeding)
+      {
+        feeding = true;
+
+        lock.unlock();
+        poll();
+        lock.lock();
+
+        feeding = false;
+        changed.notify_all();
+      }
+
+      Lane* lane = heaviest();
+
+      if (lane)
+      {
+        auto task = std::move(lane->tasks.front());
+        lane->tasks.pop_front();
+        lane->weight -= task.first;
+        lane->busy = true;
+        npending--;
+
+        lock.unlock();
+        task.second();
+        lock.lock();
+
+        lane->busy = false;
+        changed.notify_all();
+      }
+      else if (not fed and not feeding)
+      {
+        feeding = true;
+
+        lock.unlock();
+        bool more = feed();
+        lock.lock();
+
+        feeding = false;
+        fed = not more;
+        changed.notify_all();
+      }
+      else if (fed and npending == 0)
+        return;
+      else
+        changed.wait(lock);
+    }
+  }
+
+private:
+
+  Lane* heaviest()
+  {
+    Lane* heaviest = nullptr;
+    for (auto& lane : lanes)
+    {
+      if (lane.busy or lane.tasks.empty())
+        continue;
+      if (heaviest == nullptr or lane.weight > heaviest->weight)
+        heaviest = &lane;
+    }
+    return heaviest;
+  }
+};
+
+
+#endif
@@ -14,6 +14,7 @@
 #define LOCATOR_H
 
 #include "structures/serializable_bitvector.h"
+#include "utils/memory.h"
 
 
 struct Locator
@@ -25,11 +26,14 @@ private:
 
   static constexpr uint32_t metasize = 4;
 
+  MemoryCharge charge;
+
 public:
 
   Locator(uint32_t range)
   {
     buffer = new uint32_t[range + metasize];
+    charge.add(MemoryCategory::LOCATORS, (range + metasize) * sizeof(uint32_t));
     buffer[3] = 0; /* Uninitialized = 0, RowGrp/ColGrp = 1, Dashboard = 2 */
   }
 
@@ -0,0 +1,239 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "utils/enum.h"
+#include "utils/env.h"
+#include "utils/log.h"
+
+
+class MemoryCategory : public Enum {
+public:
+  using Enum::Enum;
+  static constexpr int OTHER        = 0;  // Default (i.e., outside any Memory::Scope)
+  static constexpr int TILES        = 1;  // CSC tiles
+  static constexpr int LOCATORS     = 2;  // Locators of the row/col groups and dashboards
+  static constexpr int GROUPS       = 3;  // Bitvectors of the row/col groups and dashboards
+  static constexpr int STATES       = 4;  // Master vertex segments
+  static constexpr int MIRRORS      = 5;  // Mirror vertex segments (and their masters' buffers)
+  static constexpr int MESSAGES     = 6;  // Message segments (x)
+  static constexpr int ACCUMULATORS = 7;  // Final and partial accumulator segments (y)
+  static constexpr int BLOBS        = 8;  // Serialized segments (e.g., in flight)
+  static constexpr int ARENAS       = 9;  // Chunks of the per-thread arenas (see Arena)
+  static constexpr int COUNT        = 10;
+
+  const char* name() const { return names()[value]; }
+
+private:
+  static const char* const* names()
+  {
+    static const char* const NAMES[] = {"other", "tiles", "locators", "groups", "states",
+                                        "mirrors", "messages", "accumulators", "blobs", "arenas"};
+    return NAMES;
+  }
+};
+
+
+/**
+ * Memory accounting of the engine's data structures: the bytes they allocate, per category,
+ * currently and at peak, per rank. report() prints the cluster stats (like DistTimer::report()).
+ *
+ * A structure charges its allocations to the category of the innermost Memory::Scope of the
+ * allocating thread (OTHER if none), unless it gives its own (e.g., a CSC its TILES); it keeps
+ * them in a MemoryCharge, which credits them back once freed. Blobs are charged as allocated
+ * and freed by Communicable.
+ **/
+
+class Memory
+{
+public:
+
+  /** Charge what the calling thread allocates, while in scope, to the given category. **/
+  class Scope
+  {
+  public:
+    Scope(MemoryCategory category) : previous(current()) { current() = category; }
+
+    ~Scope() { current() = previous; }
+
+  private:
+    MemoryCategory previous;
+  };
+
+  /** The category of the calling thread's scope. **/
+  static MemoryCategory category() { return current(); }
+
+  static void allocated(MemoryCategory category, uint64_t nbytes)
+  {
+    uint64_t now = (counters()[category].current += nbytes);
+    raise(counters()[category].peak, now);
+    raise(counters()[MemoryCategory::COUNT].peak, counters()[MemoryCategory::COUNT].current
+                                                  += nbytes);
+  }
+
+  static void freed(MemoryCategory category, uint64_t nbytes)
+  {
+    counters()[category].current -= nbytes;
+    counters()[MemoryCategory::COUNT].current -= nbytes;
+  }
+
+  /** (By Communicable:) a blob of nbytes was allocated. **/
+  static void allocated_blob(const void* blob, uint64_t nbytes)
+  {
+    if (blob == nullptr)
+      return;
+
+    Blobs& blobs = get_blobs();
+    {
+      std::lock_guard<std::mutex> lock(blobs.mutex);
+      auto it = blobs.nbytes.find(blob);
+      if (it != blobs.nbytes.end())
+        freed(MemoryCategory::BLOBS, it->second);  // (Freed elsewhere: its address was reused.)
+      blobs.nbytes[blob] = nbytes;
+    }
+    allocated(MemoryCategory::BLOBS, nbytes);
+  }
+
+  /** (By Communicable:) a blob is about to be freed (a no-op unless charged). **/
+  static void freed_blob(const void* blob)
+  {
+    Blobs& blobs = get_blobs();
+    std::lock_guard<std::mutex> lock(blobs.mutex);
+    auto it = blobs.nbytes.find(blob);
+    if (it == blobs.nbytes.end())
+      return;
+    freed(MemoryCategory::BLOBS, it->second);
+    blobs.nbytes.erase(it);
+  }
+
+  static uint64_t current_nbytes(MemoryCategory category) { return counters()[category].current; }
+
+  static uint64_t peak_nbytes(MemoryCategory category) { return counters()[category].peak; }
+
+  /** Print the current and peak KBs of every category in use (and in total), across the ranks
+      (collective). **/
+  static void report()
+  {
+    constexpr int n = MemoryCategory::COUNT + 1;  // (With the total.)
+
+    std::vector<double> mine(2 * n);
+    for (int c = 0; c < n; c++)
+    {
+      mine[2 * c] = counters()[c].current / 1024.0;
+      mine[2 * c + 1] = counters()[c].peak / 1024.0;
+    }
+
+    std::vector<double> all(2 * n * Env::nranks);
+    MPI_Gather(mine.data(), 2 * n, MPI_DOUBLE, all.data(), 2 * n, MPI_DOUBLE, 0, Env::MPI_WORLD);
+
+    for (int c = 0; c < n; c++)
+    {
+      double avg = 0, avg_peak = 0;
+      uint32_t min = 0, max = 0;  // (Ranks, by peak.)
+
+      for (int r = 0; r < Env::nranks; r++)
+      {
+        const double* stats = &all[2 * n * r + 2 * c];
+        avg += stats[0] / Env::nranks;
+        avg_peak += stats[1] / Env::nranks;
+        if (stats[1] < all[2 * n * min + 2 * c + 1]) min = r;
+        if (stats[1] > all[2 * n * max + 2 * c + 1]) max = r;
+      }
+
+      if (avg_peak == 0)
+        continue;
+
+      LOG.info("Memory <%s> stats: %.1lf KB on average (peak %.1lf KB on average) "
+               "(peak %.1lf [on %u] -> %.1lf [on %u]) \n",
+               c < MemoryCategory::COUNT ? MemoryCategory(c).name() : "total", avg, avg_peak,
+               all[2 * n * min + 2 * c + 1], min, all[2 * n * max + 2 * c + 1], max);
+    }
+  }
+
+private:
+  struct Counter
+  {
+    std::atomic<uint64_t> current{0};
+    std::atomic<uint64_t> peak{0};
+  };
+
+  struct Blobs
+  {
+    std::unordered_map<const void*, uint64_t> nbytes;
+    std::mutex mutex;
+  };
+
+  static MemoryCategory& current()
+  {
+    static thread_local MemoryCategory category;
+    return category;
+  }
+
+  static Counter* counters()  // per category, then the total
+  {
+    static Counter all[MemoryCategory::COUNT + 1];
+    return all;
+  }
+
+  static Blobs& get_blobs()
+  {
+    static Blobs blobs;
+    return blobs;
+  }
+
+  static void raise(std::atomic<uint64_t>& peak, uint64_t now)
+  {
+    uint64_t seen = peak;
+    while (now > seen and not peak.compare_exchange_weak(seen, now)) {}
+  }
+};
+
+
+/**
+ * The bytes a structure allocated (see Memory), under the category of its first allocation
+ * (i.e., of the allocating thread's scope) unless given. Credited back by release(), or once
+ * destroyed. Not copied along with the structure.
+ **/
+
+class MemoryCharge
+{
+public:
+  MemoryCharge() {}
+
+  MemoryCharge(const MemoryCharge&) {}
+
+  MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+  ~MemoryCharge() { release(); }
+
+  void add(uint64_t nbytes_) { add(nbytes == 0 ? Memory::category() : category, nbytes_); }
+
+  void add(MemoryCategory category_, uint64_t nbytes_)
+  {
+    if (nbytes > 0)
+      Memory::freed(category, nbytes);  // (Moved to the given category.)
+    category = category_;
+    nbytes += nbytes_;
+    Memory::allocated(category, nbytes);
+  }
+
+  void release()
+  {
+    Memory::freed(category, nbytes);
+    nbytes = 0;
+  }
+
+  uint64_t get_nbytes() const { return nbytes; }
+
+private:
+  MemoryCategory category;
+
+  uint64_t nbytes = 0;
+};
+
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef OUT_OF_CORE_H
+#define OUT_OF_CORE_H
+
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <sys/mman.h>
+#include <type_traits>
+#include <unistd.h>
+#include <unordered_map>
+#include "utils/common.h"
+#include "utils/env.h"
+
+
+/**
+ * Out-of-core storage ($LA3_OOC_DIR, see Env::ooc_dir): arrays backed by a per-rank file in that
+ * directory (unlinked as soon as it is created) instead of memory.
+ *
+ * Such arrays are mapped from the file, so that the kernel reads their pages in on demand and
+ * may evict them (after writing them back, if mapped writable) under memory pressure. The CSC
+ * tiles are mapped read-only (see CSC::spill()); large vertex state segments read-write.
+ **/
+
+class OutOfCore
+{
+public:
+  /* Smaller arrays are not worth a mapping: spill_array() leaves them in memory. */
+  static constexpr size_t MIN_ARRAY_NBYTES = 1 << 20;
+
+  static bool enabled() { return not Env::ooc_dir.empty(); }
+
+  /** Bytes appended to the file so far. **/
+  static uint64_t nbytes() { return enabled() ? get_file().end : 0; }
+
+  /** Append nbytes of data to the file and map them back (at a page boundary). **/
+  static void* map(const void* data, size_t nbytes, bool writable)
+  {
+    if (nbytes == 0)
+      return nullptr;
+
+    File& file = get_file();
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    off_t offset;
+    {
+      std::lock_guard<std::mutex> lock(file.mutex);
+      offset = file.end;
+      file.end += (nbytes + page - 1) / page * page;
+    }
+
+    for (size_t done = 0; done < nbytes;)
+    {
+      ssize_t n = pwrite(file.fd, (const char*) data + done, nbytes - done, offset + done);
+      if (n <= 0)
+      {
+        LOG.error("Unable to write out-of-core file (%s) \n", strerror(errno));
+        Env::exit(1);
+      }
+      done += n;
+    }
+
+    void* ptr = mmap(nullptr, nbytes, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED,
+                     file.fd, offset);
+    if (ptr == MAP_FAILED)
+    {
+      LOG.error("Unable to map out-of-core file (%s) \n", strerror(errno));
+      Env::exit(1);
+    }
+    return ptr;
+  }
+
+  /** Hint the kernel about the coming accesses to a mapped range (e.g., MADV_WILLNEED). **/
+  static void advise(const void* ptr, size_t nbytes, int advice)
+  {
+    if (ptr == nullptr or nbytes == 0)
+      return;
+    size_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t begin = (uintptr_t) ptr / page * page;
+    madvise((void*) begin, (uintptr_t) ptr + nbytes - begin, advice);
+  }
+
+  /**
+   * Move an array allocated with new[] to the file (mapped read-write), if its values can be
+   * copied bytewise and it is large enough. Free it with free_array() from then on.
+   **/
+  template <class T>
+  static T* spill_array(T* vals, size_t n)
+  {
+    if (not std::is_trivially_copyable<T>::value or n * sizeof(T) < MIN_ARRAY_NBYTES)
+      return vals;
+
+    T* mapped = (T*) map(vals, n * sizeof(T), true);
+    advise(mapped, n * sizeof(T), MADV_RANDOM);  // (Accessed by vertex.)
+
+    File& file = get_file();
+    {
+      std::lock_guard<std::mutex> lock(file.mutex);
+      file.arrays[mapped] = n * sizeof(T);
+    }
+
+    delete[] vals;
+    return mapped;
+  }
+
+  /** Free an array allocated with new[], or moved to the file by spill_array(). **/
+  template <class T>
+  static void free_array(T* vals)
+  {
+    if (enabled() and vals != nullptr)
+    {
+      File& file = get_file();
+      std::lock_guard<std::mutex> lock(file.mutex);
+      auto it = file.arrays.find(vals);
+      if (it != file.arrays.end())
+      {
+        munmap(vals, it->second);
+        file.arrays.erase(it);
+        return;
+      }
+    }
+    delete[] vals;
+  }
+
+private:
+  struct File
+  {
+    int fd = -1;
+
+    off_t end = 0;
+
+    std::unordered_map<const void*, size_t> arrays;  // by spill_array(): their nbytes
+
+    std::mutex mutex;
+
+    File()
+    {
+      std::string path = Env::ooc_dir + "/la3." + std::to_string(Env::rank) + ".ooc";
+      fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+      if (fd < 0)
+      {
+        LOG.error("Unable to create out-of-core file %s (%s) \n", path.c_str(), strerror(errno));
+        Env::exit(1);
+      }
+      unlink(path.c_str());  // (Its space is freed once the file is closed and unmapped.)
+    }
+
+    ~File() { close(fd); }
+  };
+
+  static File& get_file()
+  {
+    static File file;
+    return file;
+  }
+};
+
+
+#endif
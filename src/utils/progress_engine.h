@@ -0,0 +1,173 @@
+#ifndef PROGRESS_ENGINE_H
+#define PROGRESS_ENGINE_H
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <mpi.h>
+#include "utils/env.h"
+
+
+/**
+ * Communication progress engine: a per-rank thread that drives outstanding receives to
+ * completion and post-processes (deserializes) them as they complete, then hands them to the
+ * compute thread through a ready queue.
+ *
+ * Receives are handed over in batches (e.g., all incoming segments of an iteration). The compute
+ * thread then blocks on the batch's ready queue rather than polling MPI. Since testing any
+ * request lets MPI progress all of them, this also advances the (large) isends of bcast() and
+ * send() while the compute threads are busy. Requires MPI_THREAD_MULTIPLE.
+ *
+ * While any batch is outstanding, the thread spins (MPI_Testsome over each batch, then yield),
+ * i.e., it occupies a core that the OpenMP compute threads would otherwise use; it only sleeps
+ * (IDLE_USECS at a time) when it has nothing to receive.
+ **/
+
+class ProgressEngine
+{
+public:
+  /* How long the thread sleeps between nudges of MPI, while it has no receives to drive. */
+  static constexpr uint32_t IDLE_USECS = 200;
+
+  struct Batch
+  {
+    std::vector<MPI_Request> requests;  // The engine's copies; null once complete.
+
+    std::function<void(int32_t)> postprocess;  // Of the ith request, on the engine's thread.
+
+    std::vector<int32_t> ready;  // Complete and post-processed, but not yet consumed.
+
+    uint32_t num_outstanding = 0;  // Not yet complete.
+  };
+
+private:
+  std::vector<Batch*> batches;  // with outstanding requests
+
+  std::mutex mutex;
+
+  std::condition_variable submitted;
+
+  std::condition_variable completed;
+
+  bool stopping = false;
+
+  std::thread thread;
+
+public:
+
+  ProgressEngine() : thread(&ProgressEngine::run, this) {}
+
+  ~ProgressEngine()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    submitted.notify_one();
+    thread.join();
+  }
+
+  /**
+   * Hand the given (posted or started) requests over, along with how to post-process them.
+   * From now on, only the engine may test or wait for them.
+   **/
+  void submit(Batch& batch, const std::vector<MPI_Request>& requests,
+              std::function<void(int32_t)> postprocess)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    assert(batch.num_outstanding == 0);
+
+    batch.requests = requests;
+    batch.postprocess = postprocess;
+    batch.ready.clear();
+    batch.num_outstanding = std::count_if(requests.begin(), requests.end(),
+                                          [](MPI_Request r) { return r != MPI_REQUEST_NULL; });
+
+    // (The batch may still be listed, if it completed since the thread last looked.)
+    bool listed = std::find(batches.begin(), batches.end(), &batch) != batches.end();
+    if (batch.num_outstanding > 0 and not listed)
+      batches.push_back(&batch);
+    submitted.notify_one();
+  }
+
+  /** Block until some of the batch's requests are ready, then (re)fill indices with them. **/
+  void wait_for_some(Batch& batch, std::vector<int32_t>& indices)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    completed.wait(lock, [&] { return not batch.ready.empty() or batch.num_outstanding == 0; });
+
+    indices.assign(batch.ready.begin(), batch.ready.end());
+    batch.ready.clear();
+  }
+
+private:
+
+  void run()
+  {
+    std::vector<Batch*> active;
+    std::vector<int32_t> indices;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (not stopping)
+    {
+      if (batches.empty())
+      {
+        // Nothing to receive, but sends may still be outstanding: nudge MPI now and then.
+        // (A copy: binding IDLE_USECS itself to a reference would require its definition.)
+        submitted.wait_for(lock, std::chrono::microseconds((uint32_t) IDLE_USECS));
+        lock.unlock();
+        Env::progress();
+        lock.lock();
+        continue;
+      }
+
+      active = batches;  // New batches may be submitted meanwhile.
+      lock.unlock();
+
+      for (auto batch : active)
+        drive(*batch, indices);
+
+      std::this_thread::yield();  // Share the core(s) with the compute threads.
+
+      lock.lock();
+      batches.erase(std::remove_if(batches.begin(), batches.end(),
+                                   [](Batch* b) { return b->num_outstanding == 0; }),
+                    batches.end());
+    }
+  }
+
+  void drive(Batch& batch, std::vector<int32_t>& indices)
+  {
+    int32_t num_ready;
+
+    indices.resize(batch.requests.size());
+    MPI_Testsome(batch.requests.size(), batch.requests.data(), &num_ready, indices.data(),
+                 MPI_STATUSES_IGNORE);
+
+    if (num_ready == MPI_UNDEFINED or num_ready == 0)
+      return;
+
+    for (int32_t i = 0; i < num_ready; i++)
+    {
+      // Persistent requests are merely inactive now; they remain their owner's.
+      batch.requests[indices[i]] = MPI_REQUEST_NULL;
+      batch.postprocess(indices[i]);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      batch.ready.insert(batch.ready.end(), indices.begin(), indices.begin() + num_ready);
+      batch.num_outstanding -= num_ready;
+    }
+    completed.notify_all();
+  }
+};
+
+
+#endif
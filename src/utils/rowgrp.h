@@ -46,6 +46,8 @@ struct ProcessedRowGrp : AnnotatedRowGrp<Tile>
 template <class Tile>
 struct CSCRowGrp : ProcessedRowGrp<Tile>
 {
+  /* Row bands that the CSCs of its local tiles are split into (regular and sink rows). */
+  uint32_t nbands = 1, sink_nbands = 1;
 };
 
 #endif
@@ -11,7 +11,7 @@
 template <class Weight>
 struct Tile2D
 {
-  std::vector<Triple<Weight>>* triples;
+  std::vector<Triple<Weight>>* triples = nullptr;
 
   Tile2D() { allocate_triples(); }
 
@@ -1,7 +1,10 @@
 #ifndef ACCUM_FINAL_SEGMENT_H
 #define ACCUM_FINAL_SEGMENT_H
 
+#include <numeric>
 #include "structures/bitvector.h"
+#include "utils/dist_timer.h"
+#include "utils/progress_engine.h"
 
 
 /**
@@ -12,9 +15,10 @@ template <class Matrix, class Array, class PartialArray = Array>
 class AccumFinalSegment : public Array
 {
 public:
-  using Value     = typename Array::Type;
-  using Dashboard = typename Matrix::Dashboard;
-  using RanksMeta = typename Dashboard::RanksMeta;
+  using Value       = typename Array::Type;
+  using Dashboard   = typename Matrix::Dashboard;
+  using RanksMeta   = typename Dashboard::RanksMeta;
+  using ActivitySet = typename PartialArray::ActivitySet;
 
   uint32_t kth;
 
@@ -24,8 +28,6 @@ public:
 
   uint32_t sink_offset;
 
-  FixedVector<PartialArray>* partials;
-
   FixedVector<RanksMeta>* ranks_meta;
 
   std::vector<void*> blobs;
@@ -37,6 +39,45 @@ private:
 
   uint32_t tag;
 
+  /**
+   * The partials of the ranks in the row group are combined straight from their blobs (see
+   * take()), rather than deserialized into one full-size array per rank. A single array serves
+   * for the receives (e.g., to size their blobs), this rank's partial when delivered in place,
+   * and the dynamically-serialized partials, which are deserialized one at a time.
+   **/
+  PartialArray* partial;
+
+  /* The activity of the partial being taken, as decoded from its blob. */
+  ActivitySet* received;
+
+  /* Per-rank blobs and persistent requests, if bound (see bind()). */
+  std::vector<void*> bound_blobs;
+
+  std::vector<MPI_Request> bound_requests;
+
+  /* Window for co-located ranks, if any (see SharedWindow), and whether each rank is bound
+   * through it (kept, since ranks_meta may not outlive the segment). */
+  SharedWindow* window = nullptr;
+
+  std::vector<bool> windowed;
+
+  /* Progress engine driving the receives of the partials, if any (see set_engine()). */
+  ProgressEngine* engine = nullptr;
+
+  ProgressEngine::Batch batch;
+
+  /* Neighborhood exchange, if any, and this segment's (per-rank) channels in it. */
+  NeighborExchange* exchange = nullptr;
+
+  std::vector<uint32_t> channels;
+
+  /* This rank's index in the row group, if any, and the mailbox of its deliveries in place. */
+  uint32_t local_ith = UINT32_MAX;
+
+  LocalMailbox* mailbox = nullptr;
+
+  bool local = false;
+
   uint32_t determine_size(Dashboard* db, bool sink)
   {
     if (sink)
@@ -61,46 +102,186 @@ public:
     tag = Dashboard::rowgrp_tag(rg, sink);
     sink_offset = db->regular->count();
 
-    partials = new FixedVector<PartialArray>;
-    partials->reserve(ranks_meta->size());
-    for (uint32_t i = 0; i < ranks_meta->size(); i++)
-      partials->emplace_back(Array::size());
+    partial = new PartialArray(Array::size());
+    received = new ActivitySet(Array::size());
   }
 
   ~AccumFinalSegment()
   {
-    delete partials;
+    for (uint32_t i = 0; i < bound_blobs.size(); i++)
+    {
+      if (bound_blobs[i] == nullptr)
+        continue;
+      else if (windowed[i])
+        partial->unbind_shared(bound_blobs[i], &bound_requests[i]);
+      else
+        partial->unbind(bound_blobs[i], &bound_requests[i]);
+    }
+    delete partial;
+    delete received;
+    delete mailbox;
+  }
+
+  /**
+   * Bind one blob and one persistent recv request per rank in the row group, to be reused by
+   * every subsequent gather(). Requires a trivially-serializable Value.
+   * If a window is given, co-located ranks are recv'd from through it. If shared_only, only
+   * those are bound (the others are still recv'd from with irecv()).
+   **/
+  void bind(SharedWindow* window = nullptr, bool shared_only = false)
+  {
+    if (bound()) return;
+
+    this->window = window;
+
+    for (uint32_t i = 0; i < ranks_meta->size(); i++)
+    {
+      int32_t rank = (*ranks_meta)[i].rank;
+
+      MPI_Request request = MPI_REQUEST_NULL;
+      if (shared_only and not shared(rank))
+        bound_blobs.push_back(nullptr);
+      else if (shared(rank))
+        bound_blobs.push_back(partial->recv_init_shared(rank, tag, Env::MPI_WORLD, &request));
+      else
+        bound_blobs.push_back(partial->recv_init(rank, tag, Env::MPI_WORLD, &request));
+      bound_requests.push_back(request);
+      windowed.push_back(shared(rank));
+    }
+  }
+
+  bool bound() const { return not bound_blobs.empty(); }
+
+  bool bound(uint32_t i) const { return bound() and bound_blobs[i] != nullptr; }
+
+  bool shared(int32_t rank) const { return window and SharedWindow::colocated(rank); }
+
+  /**
+   * Let the engine drive the receives of the partials, from the next gather() on (they are still
+   * combined by the compute thread, see take()). Requires a trivially-serializable Value.
+   * A null engine restores the default.
+   **/
+  void set_engine(ProgressEngine* engine) { this->engine = engine; }
+
+  /**
+   * Recv through the given exchange from the next gather() on (see NeighborExchange), registering
+   * one channel per rank in the row group with it the first time. Null restores the default.
+   **/
+  void set_exchange(NeighborExchange* exchange)
+  {
+    if (exchange and channels.empty())
+      for (uint32_t i = 0; i < ranks_meta->size(); i++)
+        channels.push_back(exchange->add_recv((*ranks_meta)[i].rank, tag,
+                                              partial->blob_nbytes_max()));
+    this->exchange = exchange;
+  }
+
+  /**
+   * Let this rank's partial be delivered in place (by swapping arrays) from the next gather() on,
+   * rather than through MPI (see LocalMailbox). Returns the mailbox to deliver to, if this rank
+   * is in the row group. False restores the default.
+   **/
+  LocalMailbox* set_local(bool local)
+  {
+    for (uint32_t i = 0; i < ranks_meta->size() and local_ith == UINT32_MAX; i++)
+      if ((*ranks_meta)[i].rank == Env::rank)
+        local_ith = i;
+
+    if (local_ith == UINT32_MAX)
+      return nullptr;
+    if (not mailbox)
+      mailbox = new LocalMailbox;
+    this->local = local;
+    return mailbox;
   }
 
+  /* The partial that this rank's partial segment delivers into (see set_local()). */
+  PartialArray& local_partial() { return *partial; }
+
   void gather()
   {
     num_outstanding = ranks_meta->size();
     blobs.clear();
     requests.clear();
 
+    if (exchange)
+    {
+      // Located once exchanged (see wait_for_some()).
+      blobs.assign(ranks_meta->size(), NeighborExchange::pending());
+      requests.assign(ranks_meta->size(), MPI_REQUEST_NULL);
+      return;
+    }
+
     for (uint32_t i = 0; i < ranks_meta->size(); i++)
     {
       MPI_Request request = MPI_REQUEST_NULL;
 
-      blobs.push_back((*partials)[i].irecv((*ranks_meta)[i].rank, tag, Env::MPI_WORLD, &request));
+      if (local and i == local_ith)
+        blobs.push_back(nullptr);
+      else if (bound(i))
+      {
+        MPI_Start(&bound_requests[i]);
+        request = bound_requests[i];
+        blobs.push_back(bound_blobs[i]);
+      }
+      else
+        blobs.push_back(partial->irecv((*ranks_meta)[i].rank, tag, Env::MPI_WORLD, &request));
 
       requests.push_back(request);
     }
+
+    if (local)
+    {
+      blobs[local_ith] = LocalMailbox::pending();  // Taken once delivered.
+      requests[local_ith] = MPI_REQUEST_NULL;
+    }
+
+    if (engine)
+      engine->submit(batch, requests, [](int32_t) {});  // (Taken by the compute thread.)
   }
 
   const std::vector<int32_t>& wait_for_some()
   {
+    TraceSpan span("MPI Wait");
     int32_t num_ready;
 
+    assert(num_outstanding > 0);
+    if (local_ith < blobs.size() and blobs[local_ith] == LocalMailbox::pending()
+        and mailbox->take())
+    {
+      indices.assign(1, local_ith);
+      num_outstanding--;
+      return indices;
+    }
+
     indices.resize(requests.size());
 
-    assert(num_outstanding > 0);
+    if (exchange and blobs.front() == NeighborExchange::pending())
+    {
+      exchange->wait();  // A no-op if another segment already completed the round.
+      for (uint32_t i = 0; i < blobs.size(); i++)
+        blobs[i] = exchange->recv_blob(channels[i]);
+
+      indices.resize(num_outstanding);
+      std::iota(indices.begin(), indices.end(), 0);
+      num_outstanding = 0;
+      return indices;
+    }
+
+    if (engine)
+    {
+      engine->wait_for_some(batch, indices);
+      num_outstanding -= indices.size();
+      return indices;
+    }
+
     if (std::is_base_of<Serializable, typename Array::Type>::value)
       Communicable<Array>::irecv_dynamic_some(blobs, requests);
 
     MPI_Waitsome(requests.size(), requests.data(), &num_ready, indices.data(), MPI_STATUSES_IGNORE);
 
-    assert(num_ready != MPI_UNDEFINED);  /* TODO/CONSIDER */
+    if (num_ready == MPI_UNDEFINED)  // Only a delivery in place is outstanding, yet to come.
+      num_ready = 0;
 
     indices.resize(num_ready);
     num_outstanding -= num_ready;
@@ -110,9 +291,101 @@ public:
 
   bool no_more_segs() { return num_outstanding == 0; }
 
-  void irecv_postprocess(uint32_t jth)
+  /*
+   * Asynchronous mode (see VertexProgram::mode): the partials that are complete, if any, without
+   * blocking. Each is taken, then regather()'d, independently of the others.
+   */
+  const std::vector<int32_t>& test_for_some()
+  {
+    int32_t num_ready;
+
+    indices.resize(requests.size());
+    MPI_Testsome(requests.size(), requests.data(), &num_ready, indices.data(),
+                 MPI_STATUSES_IGNORE);
+
+    if (num_ready == MPI_UNDEFINED)
+      num_ready = 0;
+
+    indices.resize(num_ready);
+    num_outstanding -= num_ready;
+
+    return indices;
+  }
+
+  /* Re-post the receive of the jth rank's partial (once taken). */
+  void regather(uint32_t jth)
+  {
+    assert(blobs[jth] == nullptr);
+    blobs[jth] = partial->irecv((*ranks_meta)[jth].rank, tag, Env::MPI_WORLD, &requests[jth]);
+    num_outstanding++;
+  }
+
+  /* Cancel the outstanding receives (which must be yet to match). */
+  void cancel()
+  {
+    for (uint32_t jth = 0; jth < requests.size(); jth++)
+    {
+      if (requests[jth] == MPI_REQUEST_NULL)
+        continue;
+      partial->cancel_irecv(blobs[jth], &requests[jth]);
+      blobs[jth] = nullptr;
+      num_outstanding--;
+    }
+  }
+
+  /**
+   * Hand the jth partial, once received (see wait_for_some()), to visit(activity, values), where
+   * values(idx, x) is the value of its xth active index, idx; then release it. A blob is read in
+   * place (see RandomAccessArray::decode_blob()), with its activity decoded into a scratch
+   * bitvector. A partial delivered in place (or dynamically serialized, hence deserialized) is
+   * read from the array, whose entries values() re-initializes.
+   **/
+  template <class Visitor>
+  void take(uint32_t jth, Visitor visit)
   {
-    (*partials)[jth].irecv_postprocess(blobs[jth]);
+    void* blob = blobs[jth];
+    assert(blob != nullptr);
+
+    int32_t rank = (*ranks_meta)[jth].rank;
+
+    if (std::is_base_of<Serializable, Value>::value)
+    {
+      uint32_t nbytes = partial->irecv_postprocess(blob);
+      if (rank != Env::rank) Env::nbytes_recvd += nbytes;
+      blob = LocalMailbox::pending();  // (As if delivered in place.)
+    }
+
+    if (blob == LocalMailbox::pending())
+    {
+      visit(*partial->activity, [this](uint32_t idx, uint32_t) -> Value
+      {
+        Value val = (*partial)[idx];
+        (*partial)[idx] = Value();
+        return val;
+      });
+      partial->activity->clear();
+    }
+    else
+    {
+      TraceSpan span("Deserialization");  // (In place: decoding, then reading while visiting.)
+      bool reused = (bound(jth) and blob == bound_blobs[jth])
+                    or (exchange and exchange->owns(blob));
+      bool in_window = bound(jth) and blob == bound_blobs[jth] and windowed[jth];
+
+      const void* data = in_window ? partial->peek_shared(window, rank, blob) : blob;
+      const Value* values = partial->decode_blob(data, *received);
+      if (rank != Env::rank)
+        Env::nbytes_recvd += (const char*) (values + received->count()) - (const char*) data;
+
+      visit(*received, [values](uint32_t, uint32_t x) -> const Value& { return values[x]; });
+      received->clear();
+
+      if (in_window)
+        partial->release_shared(window, rank, blob);
+      else if (not reused)
+        partial->delete_blob(blob);
+    }
+
     blobs[jth] = nullptr;
     requests[jth] = MPI_REQUEST_NULL;
   }
@@ -123,6 +396,8 @@ public:
 
 
 /*
+ * NOTE: CommBackend::LOCAL now swap()'s the partial of this rank in place (see LocalMailbox).
+ *
  * TODO: If needed, benchmark the performance of self-isend()/irecv() [which is guaranteed to
  *       be correct in MPI] with just memcpy(). If roughly same speed, good.
  *       Ideally, no memcpy() even is involved. Just allow gather() to directly access the
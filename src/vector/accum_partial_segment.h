@@ -20,6 +20,8 @@ public:
 
   uint32_t ntiles;
 
+  uint32_t nbands;  // of each tile (see CSC::split()), each combined in on its own
+
   uint32_t ncombined;
 
 private:
@@ -31,6 +33,24 @@ private:
 
   MPI_Request progress;
 
+  /* Blob and persistent request reused by every send(), if bound (see bind()). */
+  void* bound_blob = nullptr;
+
+  MPI_Request bound_request = MPI_REQUEST_NULL;
+
+  /* Window of the (co-located) owner, if sending through it (see SharedWindow). */
+  SharedWindow* window = nullptr;
+
+  /* Neighborhood exchange, if any, and this segment's channel in it. */
+  NeighborExchange* exchange = nullptr;
+
+  uint32_t channel = UINT32_MAX;
+
+  /* The owner's partial of this rank to deliver to in place, if any (see set_local()). */
+  Array* local_out = nullptr;
+
+  LocalMailbox* local_mailbox = nullptr;
+
   uint32_t determine_size(const RowGrp* rowgrp, bool sink)
   {
     if (sink)
@@ -52,12 +72,66 @@ public:
     tag = Dashboard::rowgrp_tag(rg, sink);
 
     ntiles = rowgrp->local_tiles.size();
+    nbands = sink ? rowgrp->sink_nbands : rowgrp->nbands;
     ncombined = 0;
 
     progress = MPI_REQUEST_NULL;
     blob = nullptr;
   }
 
+  ~AccumPartialSegment()
+  {
+    if (bound_blob)
+    {
+      postprocess();
+      if (window)
+        Array::unbind_shared(bound_blob, &bound_request);
+      else
+        Array::unbind(bound_blob, &bound_request);
+    }
+  }
+
+  /**
+   * Bind a blob and a persistent send request, to be reused by every subsequent send().
+   * If a window is given and the owner is co-located, send through the window instead.
+   * If shared_only, bind only in that case (otherwise, keep sending with isend()).
+   **/
+  void bind(SharedWindow* window = nullptr, bool shared_only = false)
+  {
+    if (bound_blob) return;
+    if (shared_only and not (window and SharedWindow::colocated(owner))) return;
+
+    if (window and SharedWindow::colocated(owner))
+    {
+      this->window = window;
+      bound_blob = Array::send_init_shared(window, owner, tag, Env::MPI_WORLD, &bound_request);
+    }
+    else
+      bound_blob = Array::send_init(owner, tag, Env::MPI_WORLD, &bound_request);
+  }
+
+  /**
+   * Send through the given exchange from the next send() on (see NeighborExchange), registering
+   * a channel with it the first time. Null restores the default.
+   **/
+  void set_exchange(NeighborExchange* exchange)
+  {
+    if (exchange and channel == UINT32_MAX)
+      channel = exchange->add_send(owner, tag, Array::blob_nbytes_max());
+    this->exchange = exchange;
+  }
+
+  /**
+   * Deliver to the (same-rank) owner in place, by swapping with the given partial array, from the
+   * next send() on, rather than through MPI (see LocalMailbox). Null restores the default.
+   **/
+  void set_local(Array* out, LocalMailbox* mailbox)
+  {
+    assert(out == nullptr or out->size() == Array::size());
+    local_out = out;
+    local_mailbox = mailbox;
+  }
+
   /**
    * Post-process and block on the previous isend, if any.
    * Safe to be called even if no previous isend's have been posted.
@@ -77,10 +151,42 @@ public:
   void send()
   {
     postprocess();
-    blob = Array::template isend<true>(owner, tag, Env::MPI_WORLD, &progress);
+    if (local_out)
+    {
+      local_out->swap(*this);  // (Its previous contents were consumed, hence cleared.)
+      local_out->rewind();
+      Array::rewind();
+      local_mailbox->post();
+    }
+    else if (exchange)
+      Array::template send_exchange<true>(exchange, channel);
+    else if (bound_blob and window)
+      Array::template start_send_shared<true>(window, bound_blob, &bound_request, &progress);
+    else if (bound_blob)
+      Array::template start_send<true>(bound_blob, owner, tag, Env::MPI_WORLD, &bound_request,
+                                       &progress);
+    else
+      blob = Array::template isend<true>(owner, tag, Env::MPI_WORLD, &progress);
+  }
+
+  bool ready() { return ncombined == ntiles * nbands; }
+
+  /**
+   * Count one more band of a tile as combined in, possibly concurrently with others. Returns
+   * true for the last one, which then sees what all others combined in (i.e., may send()).
+   **/
+  bool combined()
+  {
+    return __atomic_add_fetch(&ncombined, 1, __ATOMIC_ACQ_REL) == ntiles * nbands;
   }
 
-  bool ready() { return ncombined == ntiles; }
+  /* Has the previous send, if any, completed? (Without blocking, unlike postprocess().) */
+  bool sent()
+  {
+    int flag;
+    MPI_Test(&progress, &flag, MPI_STATUS_IGNORE);
+    return flag;
+  }
 };
 
 
@@ -33,6 +33,8 @@ public:
 
   AccumVector(const Matrix* A)
   {
+    Memory::Scope scope(MemoryCategory::ACCUMULATORS);
+
     /* Partial accumulators are for local row groups. */
     local_segs.reserve(A->local_rowgrps.size());
     local_segs_sink.reserve(A->local_rowgrps.size());
@@ -73,6 +75,76 @@ public:
       own_segs_sink.emplace_back(&db, true);
     }
   }
+
+  /**
+   * Let the engine drive (and post-process) the receives of the final segments, from the next
+   * ones on. Requires a trivially-serializable Value. A null engine restores the default.
+   **/
+  void set_engine(ProgressEngine* engine)
+  {
+    for (auto& yseg : own_segs)      yseg.set_engine(engine);
+    for (auto& yseg : own_segs_sink) yseg.set_engine(engine);
+  }
+
+  /**
+   * Bind persistent requests to all segments (see AccumPartialSegment::bind()), through the
+   * given window between co-located ranks, or only between those if shared_only.
+   **/
+  void bind(SharedWindow* window, bool shared_only)
+  {
+    for (auto& yseg : local_segs)      yseg.bind(window, shared_only);
+    for (auto& yseg : local_segs_sink) yseg.bind(window, shared_only);
+    for (auto& yseg : own_segs)        yseg.bind(window, shared_only);
+    for (auto& yseg : own_segs_sink)   yseg.bind(window, shared_only);
+  }
+
+  /**
+   * Exchange the regular segments through the given NeighborExchange (building it the first
+   * time, which is collective), from the next gather() and send() on. Null restores the default.
+   **/
+  void set_exchange(NeighborExchange* exchange)
+  {
+    for (auto& yseg : local_segs) yseg.set_exchange(exchange);
+    for (auto& yseg : own_segs)   yseg.set_exchange(exchange);
+    if (exchange and not exchange->built())
+      exchange->build();
+    this->exchange = exchange;
+  }
+
+  /**
+   * Deliver the partials this rank sends to itself in place (see LocalMailbox), from the next
+   * gather() and send() on, rather than through MPI. False restores the default.
+   **/
+  void set_local(bool local)
+  {
+    set_local(local_segs, own_segs, local);
+    set_local(local_segs_sink, own_segs_sink, local);
+  }
+
+  /* Start exchanging the segments send() so far, if through a NeighborExchange. */
+  void flush()
+  {
+    if (exchange)
+      exchange->start();
+  }
+
+private:
+  NeighborExchange* exchange = nullptr;
+
+  static void set_local(FixedVector<PartialSegment>& partial_segs,
+                        FixedVector<FinalSegment>& final_segs, bool local)
+  {
+    for (auto& final_yseg : final_segs)
+    {
+      LocalMailbox* mailbox = final_yseg.set_local(local);
+      if (mailbox == nullptr)
+        continue;  // Not in its row group.
+
+      for (auto& yseg : partial_segs)
+        if (yseg.rg == final_yseg.rg)
+          yseg.set_local(local ? &final_yseg.local_partial() : nullptr, mailbox);
+    }
+  }
 };
 
 
@@ -29,6 +29,24 @@ private:
 
   uint32_t* num_outstanding;
 
+  /* Blob and persistent request reused by every recv(), if bound (see bind()). */
+  void* bound_blob = nullptr;
+
+  MPI_Request bound_request = MPI_REQUEST_NULL;
+
+  /* Window of the (co-located) owner, if recv'ing through it (see SharedWindow). */
+  SharedWindow* window = nullptr;
+
+  /* Neighborhood exchange, if any, and this segment's channel in it. */
+  NeighborExchange* exchange = nullptr;
+
+  uint32_t channel = UINT32_MAX;
+
+  /* Mailbox of deliveries in place, if the owner is this rank and recv'ing locally. */
+  LocalMailbox* mailbox = nullptr;
+
+  bool local = false;
+
 public:
 
   MsgIncomingSegment() {}  // for FixedVector allocation
@@ -46,14 +64,116 @@ public:
     owner = colgrp->leader;
   }
 
+  ~MsgIncomingSegment()
+  {
+    delete mailbox;
+    if (bound_blob and window)
+      Array::unbind_shared(bound_blob, &bound_request);
+    else if (bound_blob)
+      Array::unbind(bound_blob, &bound_request);
+  }
+
+  /**
+   * Bind a blob and a persistent recv request, to be reused by every subsequent recv().
+   * If a window is given and the owner is co-located, recv through the window instead.
+   * If shared_only, bind only in that case (otherwise, keep recv'ing with irecv()).
+   **/
+  void bind(SharedWindow* window = nullptr, bool shared_only = false)
+  {
+    if (bound_blob) return;
+    if (shared_only and not (window and SharedWindow::colocated(owner))) return;
+
+    int32_t tag = Dashboard::colgrp_tag(cg, source);
+    if (window and SharedWindow::colocated(owner))
+    {
+      this->window = window;
+      bound_blob = Array::recv_init_shared(owner, tag, Env::MPI_WORLD, &bound_request);
+    }
+    else
+      bound_blob = Array::recv_init(owner, tag, Env::MPI_WORLD, &bound_request);
+  }
+
+  /**
+   * Recv through the given exchange from the next recv() on (see NeighborExchange), registering
+   * a channel with it the first time. Null restores the default.
+   **/
+  void set_exchange(NeighborExchange* exchange)
+  {
+    if (exchange and channel == UINT32_MAX)
+      channel = exchange->add_recv(owner, Dashboard::colgrp_tag(cg, source),
+                                   Array::blob_nbytes_max());
+    this->exchange = exchange;
+  }
+
+  /**
+   * If owned by this rank, let its sender deliver in place from the next recv() on (see
+   * LocalMailbox), and return the mailbox to deliver to. False restores the default.
+   **/
+  LocalMailbox* set_local(bool local)
+  {
+    if (owner != Env::rank)
+      return nullptr;
+    if (not mailbox)
+      mailbox = new LocalMailbox;
+    this->local = local;
+    return mailbox;
+  }
+
+  /* Codec of the (floating-point) messages recv'd from now on: that of their sender. */
+  void set_value_codec(ValueCodec codec) { Array::value_codec = codec; }
+
+  /* Has a delivery in place (to a pending() blob) been posted since it was last taken? */
+  bool take_local() { return mailbox and mailbox->take(); }
+
+  /* The blob of the exchange's last completed round. */
+  void* exchanged_blob() { return exchange->recv_blob(channel); }
+
+  /* Posts into the jth slot of the shared blobs and requests (re-posting it, if consumed). */
   void recv()
   {
-    MPI_Request progress = MPI_REQUEST_NULL;
-    recv_blobs->push_back( /* Post-processed with irecv_postprocess(blob, sub_size) */
-        Array::irecv(owner, Dashboard::colgrp_tag(cg, source), Env::MPI_WORLD, &progress));
-    recv_requests->push_back(progress);
+    if (recv_blobs->size() <= jth)
+    {
+      recv_blobs->resize(jth + 1, nullptr);
+      recv_requests->resize(jth + 1, MPI_REQUEST_NULL);
+    }
+
+    void*& blob = (*recv_blobs)[jth];
+    MPI_Request& progress = (*recv_requests)[jth];
+    assert(blob == nullptr);
+
+    if (local)
+      blob = LocalMailbox::pending();  // Taken once delivered.
+    else if (exchange)
+      blob = NeighborExchange::pending();  // Located once exchanged.
+    else if (bound_blob)
+    {
+      MPI_Start(&bound_request);
+      progress = bound_request;
+      blob = bound_blob;
+    }
+    else  /* Post-processed with irecv_postprocess(blob, sub_size) */
+      blob = Array::irecv(owner, Dashboard::colgrp_tag(cg, source), Env::MPI_WORLD, &progress);
     (*num_outstanding)++;
   }
+
+  /* A bound blob is kept for the next recv(), rather than deleted. */
+  void irecv_postprocess(void* blob)
+  {
+    uint32_t nbytes;
+
+    if (blob == LocalMailbox::pending())
+      return;  // Already in place.
+    else if (exchange and exchange->owns(blob))
+      nbytes = Array::recv_postprocess(blob);
+    else if (blob == bound_blob and window)
+      nbytes = Array::recv_postprocess_shared(window, owner, blob);
+    else if (blob == bound_blob)
+      nbytes = Array::recv_postprocess(blob);
+    else
+      nbytes = Array::irecv_postprocess(blob);
+
+    if (owner != Env::rank) Env::nbytes_recvd += nbytes;
+  }
 };
 
 
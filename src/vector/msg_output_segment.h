@@ -31,6 +31,27 @@ private:
 
   std::vector<void*> blobs;
 
+  /* Per-rank blobs and persistent requests, if bound (see bind()). */
+  std::vector<MPI_Request> bound_requests;
+
+  std::vector<void*> bound_blobs;
+
+  /* Window for co-located ranks, if any (see SharedWindow), and whether each rank is bound
+   * through it (kept, since ranks_meta may not outlive the segment). */
+  SharedWindow* window = nullptr;
+
+  std::vector<bool> windowed;
+
+  /* Neighborhood exchange, if any, and this segment's (per-rank) channels in it. */
+  NeighborExchange* exchange = nullptr;
+
+  std::vector<uint32_t> channels;
+
+  /* The incoming segment of this rank to deliver to in place, if any (see set_local()). */
+  Array* local_in = nullptr;
+
+  LocalMailbox* local_mailbox = nullptr;
+
   SendArray* out;
 
   bool source;
@@ -63,9 +84,95 @@ public:
 
   ~MsgOutgoingSegment()
   {
+    if (bound())
+    {
+      postprocess();
+      for (uint32_t i = 0; i < bound_blobs.size(); i++)
+      {
+        if (bound_blobs[i] == nullptr)
+          continue;
+        else if (windowed[i])
+          out->unbind_shared(bound_blobs[i], &bound_requests[i]);
+        else
+          out->unbind(bound_blobs[i], &bound_requests[i]);
+      }
+    }
     delete out;
   }
 
+  /**
+   * Bind one blob and one persistent send request per rank in the column group, to be reused
+   * by every subsequent bcast(). Requires a trivially-serializable Value.
+   * If a window is given, co-located ranks are sent to through it. If shared_only, only those
+   * are bound (the others are still sent to with isend()).
+   **/
+  void bind(SharedWindow* window = nullptr, bool shared_only = false)
+  {
+    if (bound()) return;
+
+    this->window = window;
+
+    for (uint32_t i = 0; i < ranks_meta->size(); i++)
+    {
+      auto& rank_regular = source ? (*ranks_meta)[i].sub_other : (*ranks_meta)[i].sub_regular;
+      out->temporarily_resize(rank_regular.count());
+
+      int32_t rank = (*ranks_meta)[i].rank;
+      int32_t tag = Dashboard::colgrp_tag(cg, source);
+
+      MPI_Request request = MPI_REQUEST_NULL;
+      if (shared_only and not shared(rank))
+        bound_blobs.push_back(nullptr);
+      else if (shared(rank))
+        bound_blobs.push_back(out->send_init_shared(window, rank, tag, Env::MPI_WORLD, &request));
+      else
+        bound_blobs.push_back(out->send_init(rank, tag, Env::MPI_WORLD, &request));
+      bound_requests.push_back(request);
+      windowed.push_back(shared(rank));
+    }
+  }
+
+  bool bound() const { return not bound_blobs.empty(); }
+
+  bool bound(uint32_t i) const { return bound() and bound_blobs[i] != nullptr; }
+
+  bool shared(int32_t rank) const { return window and SharedWindow::colocated(rank); }
+
+  /**
+   * Send through the given exchange from the next bcast() on (see NeighborExchange), registering
+   * one channel per rank in the column group with it the first time. Null restores the default.
+   **/
+  void set_exchange(NeighborExchange* exchange)
+  {
+    if (exchange and channels.empty())
+    {
+      for (uint32_t i = 0; i < ranks_meta->size(); i++)
+      {
+        auto& rank_regular = source ? (*ranks_meta)[i].sub_other : (*ranks_meta)[i].sub_regular;
+        out->temporarily_resize(rank_regular.count());
+        channels.push_back(exchange->add_send((*ranks_meta)[i].rank,
+                                              Dashboard::colgrp_tag(cg, source),
+                                              out->blob_nbytes_max()));
+      }
+    }
+    this->exchange = exchange;
+  }
+
+  /**
+   * Deliver to this rank in place, into the given (incoming) array, from the next bcast() on,
+   * rather than through MPI (see LocalMailbox). Null restores the default.
+   **/
+  void set_local(Array* in, LocalMailbox* mailbox)
+  {
+    assert(in == nullptr or in->size() == (source ? ranks_meta->back().sub_other
+                                                  : ranks_meta->back().sub_regular).count());
+    local_in = in;
+    local_mailbox = mailbox;
+  }
+
+  /* Lossy on-the-wire codec for the (floating-point) messages sent from now on. */
+  void set_value_codec(ValueCodec codec) { out->value_codec = codec; }
+
   /* Post process previous iteration's requests and blobs, if any. */
   void postprocess()
   {
@@ -77,6 +184,17 @@ public:
     blobs.clear();
   }
 
+  /* Have the previous bcast's sends, if any, completed? (Without blocking.) */
+  bool sent()
+  {
+    int flag;
+    MPI_Testall(requests.size(), requests.data(), &flag, MPI_STATUSES_IGNORE);
+    return flag;
+  }
+
+  /* The number of ranks every bcast() sends to (one message each, possibly empty). */
+  uint32_t nranks() const { return ranks_meta->size(); }
+
   void bcast()
   {
     //LOG.info<false>("Bcasting xseg with count %u\n", this->activity->count());
@@ -104,11 +222,54 @@ private:
   void send_to_rank_ith(uint32_t i)
   {
     auto& rank_regular = source ? (*ranks_meta)[i].sub_other : (*ranks_meta)[i].sub_regular;
+
+    if (local_in and (*ranks_meta)[i].rank == Env::rank)
+    {
+      deliver_locally<destructive>(rank_regular);
+      return;
+    }
+
     out->temporarily_resize(rank_regular.count());
+    out->rewind();
+
+    select_into<destructive>(rank_regular, *out);
+
+    if ((*ranks_meta)[i].rank != Env::rank) Env::nmsgs_sent += out->activity->count();
+
+    /* Destructive isend() that clears up the `out` array. */
+    //LOG.info<false>("During bcast, sending with count %u (hey, z = %u) to %u\n",
+    // out->activity->count(), z, (*ranks_meta)[i].rank);
+
+    //LOG.info<false>("Bcasting xseg pushing out 1 \n");
+
+    if (exchange)
+    {
+      out->template send_exchange<true>(exchange, channels[i]);
+      return;
+    }
+
+    MPI_Request request;
+    if (bound(i) and windowed[i])
+      out->template start_send_shared<true>(window, bound_blobs[i], &bound_requests[i], &request);
+    else if (bound(i))
+      out->template start_send<true>(bound_blobs[i], (*ranks_meta)[i].rank,
+                                     Dashboard::colgrp_tag(cg, source), Env::MPI_WORLD,
+                                     &bound_requests[i], &request);
+    else
+      blobs.push_back(out->template isend<true /* NOT "destructive" */>(
+          (*ranks_meta)[i].rank, Dashboard::colgrp_tag(cg, source), Env::MPI_WORLD, &request));
 
+    //LOG.info<false>("Bcasting xseg pushing out 2 \n");
+
+    requests.push_back(request);
+  }
+
+  /* Push the entries that the rank's sub-vector has, re-indexed densely, into target. */
+  template <bool destructive, class RankRegular, class Target>
+  void select_into(RankRegular& rank_regular, Target& target)
+  {
     rank_regular.rewind();
     Array::rewind();
-    out->rewind();
 
     uint32_t rank_idx, val_idx;
     Value val;
@@ -126,7 +287,7 @@ private:
         // using std::to_string;
         //LOG.info<false>("out->push(%u, %s) [rank_idx = %u, val_idx = %u]\n", z, to_string(val).c_str(),
         //  rank_idx_, val_idx_);
-        out->push(z, val);
+        target.push(z, val);
       }
       if (rank_idx_ <= val_idx_)
       {
@@ -136,20 +297,24 @@ private:
       if (rank_idx_ >= val_idx_)
         nonzero = Array::template advance<destructive>(val_idx, val);
     }
+  }
 
-    /* Destructive isend() that clears up the `out` array. */
-    //LOG.info<false>("During bcast, sending with count %u (hey, z = %u) to %u\n",
-    // out->activity->count(), z, (*ranks_meta)[i].rank);
-
-    //LOG.info<false>("Bcasting xseg pushing out 1 \n");
-
-    MPI_Request request;
-    blobs.push_back(out->template isend<true /* NOT "destructive" */>(
-        (*ranks_meta)[i].rank, Dashboard::colgrp_tag(cg, source), Env::MPI_WORLD, &request));
+  /**
+   * Write the rank's entries straight into its incoming array (consumed by now), then post. If it
+   * has all of them (e.g., a single rank), the arrays are swapped instead: bcast() then clears.
+   **/
+  template <bool destructive, class RankRegular>
+  void deliver_locally(RankRegular& rank_regular)
+  {
+    local_in->clear();
 
-    //LOG.info<false>("Bcasting xseg pushing out 2 \n");
+    if (destructive and rank_regular.count() == Array::size())
+      local_in->swap(*this);
+    else
+      select_into<destructive>(rank_regular, *local_in);
 
-    requests.push_back(request);
+    local_in->rewind();
+    local_mailbox->post();
   }
 };
 
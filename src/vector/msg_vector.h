@@ -6,6 +6,7 @@
 #include "structures/fixed_vector.h"
 #include "structures/communicable.h"
 #include "utils/common.h"
+#include "utils/progress_engine.h"
 #include "vector/msg_input_segment.h"
 #include "vector/msg_output_segment.h"
 
@@ -48,10 +49,22 @@ private:
 
   std::vector<MPI_Request> source_requests;
 
+  /* Progress engine driving the regular receives, if any (see set_engine()). */
+  ProgressEngine* engine = nullptr;
+
+  ProgressEngine::Batch batch;
+
+  bool tracked = false;
+
+  /* Neighborhood exchange of the regular segments, if any (see set_exchange()). */
+  NeighborExchange* exchange = nullptr;
+
 public:
 
   MsgVector(const Matrix* A)
   {
+    Memory::Scope scope(MemoryCategory::MESSAGES);
+
     num_outstanding = 0;
 
     /* Incoming messages are for local column groups. */
@@ -86,7 +99,11 @@ public:
     MPI_Waitall(source_requests.size(), source_requests.data(), MPI_STATUSES_IGNORE);
 
     for (auto& xseg : incoming.source)
+    {
+      if (source_blobs[xseg.jth] == LocalMailbox::pending())
+        xseg.take_local();  // Delivered in place (by the bcast() before).
       xseg.irecv_postprocess(source_blobs[xseg.jth]);
+    }
 
     source_requests.clear();
     source_blobs.clear();
@@ -96,7 +113,66 @@ public:
   }
 
   std::vector<int32_t>* wait_for_some()
-  { return collect<true>(); }
+  {
+    TraceSpan span("MPI Wait");
+    return collect<true>();
+  }
+
+  /**
+   * Let the engine drive (and post-process) the regular receives, from the next ones on.
+   * Requires a trivially-serializable Value. A null engine restores the default.
+   **/
+  void set_engine(ProgressEngine* engine) { this->engine = engine; }
+
+  /**
+   * Bind persistent requests to the regular segments (see MsgOutputSegment::bind()), through
+   * the given window between co-located ranks, or only between those if shared_only.
+   **/
+  void bind(SharedWindow* window, bool shared_only)
+  {
+    for (auto& xseg : outgoing.regular) xseg.bind(window, shared_only);
+    for (auto& xseg : incoming.regular) xseg.bind(window, shared_only);
+  }
+
+  /**
+   * Exchange the regular segments through the given NeighborExchange (building it the first
+   * time, which is collective), from the next recv() and bcast() on. Null restores the default.
+   **/
+  void set_exchange(NeighborExchange* exchange)
+  {
+    for (auto& xseg : outgoing.regular) xseg.set_exchange(exchange);
+    for (auto& xseg : incoming.regular) xseg.set_exchange(exchange);
+    if (exchange and not exchange->built())
+      exchange->build();
+    this->exchange = exchange;
+  }
+
+  /**
+   * Deliver the segments this rank sends to itself in place (see LocalMailbox), from the next
+   * recv() and bcast() on, rather than through MPI. False restores the default.
+   **/
+  void set_local(bool local)
+  {
+    set_local(outgoing.regular, incoming.regular, local);
+    set_local(outgoing.source, incoming.source, local);
+  }
+
+  /* Start exchanging the segments bcast() so far, if through a NeighborExchange. */
+  void flush()
+  {
+    if (exchange)
+      exchange->start();
+  }
+
+  /* Hand the receives posted so far (by the segments' recv()) to the engine, if any. */
+  void track()
+  {
+    if (engine and not tracked and not requests.empty())
+    {
+      engine->submit(batch, requests, [this](int32_t jth) { irecv_postprocess(jth); });
+      tracked = true;
+    }
+  }
 
   bool no_more_segs_then_clear()
   {
@@ -104,16 +180,58 @@ public:
     {
       requests.clear();
       blobs.clear();
+      tracked = false;
       return true;
     }
     return false;
   }
 
+  /* Wait for, and post-process, all outstanding regular segments (e.g., after the last iter). */
+  void drain()
+  {
+    if (requests.empty())
+      return;
+
+    while (not no_more_segs())
+      collect<true>();
+
+    for (uint32_t jth = 0; jth < blobs.size(); jth++)
+      irecv_postprocess(jth);
+
+    no_more_segs_then_clear();
+  }
+
   bool no_more_segs() const { return (num_outstanding == 0); }
 
+  /*
+   * Asynchronous mode (see VertexProgram::mode): the regular segments that are complete, if any,
+   * without blocking. Each is post-processed, then recv()'d again, independently of the others.
+   */
+  std::vector<int32_t>* test_for_some() { return collect<false>(); }
+
+  /* Cancel the outstanding regular receives (which must be yet to match), then clear. */
+  void cancel()
+  {
+    for (uint32_t jth = 0; jth < requests.size(); jth++)
+    {
+      if (requests[jth] == MPI_REQUEST_NULL)
+        continue;
+      incoming.regular[jth].cancel_irecv(blobs[jth], &requests[jth]);
+      num_outstanding--;
+    }
+
+    no_more_segs_then_clear();
+  }
+
   // Regulars only; sources are handled by wait_for_sources.
+  // A no-op if already post-processed (e.g., by the engine).
   void irecv_postprocess(uint32_t jth)
   {
+    if (blobs[jth] == nullptr)
+      return;
+
+    if (blobs[jth] != LocalMailbox::pending())  // (Unless delivered in place.)
+      incoming.regular[jth].clear();
     incoming.regular[jth].irecv_postprocess(blobs[jth]);
     blobs[jth] = nullptr;
     requests[jth] = MPI_REQUEST_NULL;
@@ -121,6 +239,33 @@ public:
 
 private:
 
+  template <class Outgoing, class Incoming>
+  static void set_local(Outgoing& outgoing, Incoming& incoming, bool local)
+  {
+    for (auto& xseg_in : incoming)
+    {
+      LocalMailbox* mailbox = xseg_in.set_local(local);
+      if (mailbox == nullptr)
+        continue;  // Not from this rank.
+
+      for (auto& xseg_out : outgoing)
+        if (xseg_out.cg == xseg_in.cg)
+          xseg_out.set_local(local ? &xseg_in : nullptr, mailbox);
+    }
+  }
+
+  /* The segments delivered in place since last collected, if any. */
+  bool collect_local()
+  {
+    indices.clear();
+    for (auto& xseg : incoming.regular)
+      if (blobs[xseg.jth] == LocalMailbox::pending() and xseg.take_local())
+        indices.push_back(xseg.jth);
+
+    num_outstanding -= indices.size();
+    return not indices.empty();
+  }
+
   template <bool wait>
   std::vector<int32_t>* collect()
   {
@@ -137,9 +282,33 @@ private:
 
     assert(requests.size() == incoming.regular.size());
     assert(blobs.size() == incoming.regular.size());
+
+    if (collect_local())
+      return &indices;
+
     indices.resize(requests.size());
 
     assert(num_outstanding > 0);
+    if (exchange and blobs.front() == NeighborExchange::pending())
+    {
+      exchange->wait();
+      for (auto& xseg : incoming.regular)
+        blobs[xseg.jth] = xseg.exchanged_blob();
+
+      indices.resize(num_outstanding);
+      std::iota(indices.begin(), indices.end(), 0);
+      num_outstanding = 0;
+      return &indices;
+    }
+
+    if (engine)
+    {
+      track();
+      engine->wait_for_some(batch, indices);  // Post-processed already.
+      num_outstanding -= indices.size();
+      return &indices;
+    }
+
     if (std::is_base_of<Serializable, typename Array::Type>::value)
       Communicable<Array>::irecv_dynamic_some(blobs, requests);
 
@@ -148,7 +317,8 @@ private:
     else
       MPI_Testsome(requests.size(), requests.data(), &num_ready, indices.data(), MPI_STATUSES_IGNORE);
 
-    assert(num_ready != MPI_UNDEFINED);  /* TODO/CONSIDER */
+    if (num_ready == MPI_UNDEFINED)  // Only deliveries in place are outstanding, yet to come.
+      num_ready = 0;
 
     indices.resize(num_ready);
 
@@ -1,6 +1,7 @@
 #ifndef VERTEX_MASTER_SEGMENT_H
 #define VERTEX_MASTER_SEGMENT_H
 
+#include "matrix/hashers.h"
 #include "utils/locator.h"
 
 
@@ -30,9 +31,13 @@ public:
 
   uint32_t* original_from_internal_map;
 
+  uint32_t* original_ids = nullptr;  // Unhashed, by internal idx (see map_original_ids()).
+
 private:
   FixedVector<RanksMeta>* ranks_meta;
 
+  MemoryCharge ids_charge;  // (Of the maps above.)
+
 public:  // TODO: revert to private
   struct Out
   {
@@ -87,6 +92,7 @@ public:
     assert(db->rowgrp->offset == db->colgrp->offset);
 
     original_from_internal_map = new uint32_t[Array::size()];
+    ids_charge.add(MemoryCategory::STATES, Array::size() * sizeof(uint32_t));
 
     for (uint32_t i = 0; i < Array::size(); i++)
       original_from_internal_map[(*locator)[i]] = i;
@@ -101,11 +107,15 @@ public:
      */
     assert(ranks_meta->size() > 0);
     assert(ranks_meta->back().rank == Env::rank);
+
+    if (OutOfCore::enabled())
+      Array::spill();  // File-backed, if large.
   }
 
   ~VertexMasterSegment()
   {
     delete[] original_from_internal_map;
+    delete[] original_ids;
     delete out_reg;
     delete out_snk;
     out_reg = nullptr;
@@ -134,6 +144,20 @@ public:
     return original_from_internal_map[idx - offset];
   }
 
+  /** Precompute the original ID of every vertex (once), rather than unhash() it every time. **/
+  void map_original_ids(const ReversibleHasher* hasher)
+  {
+    if (original_ids)
+      return;
+
+    original_ids = new uint32_t[Array::size()];
+    ids_charge.add(MemoryCategory::STATES, Array::size() * sizeof(uint32_t));
+
+    #pragma omp parallel for schedule(static)
+    for (uint32_t i = 0; i < Array::size(); i++)
+      original_ids[i] = (uint32_t) hasher->unhash(offset + original_from_internal_map[i]);
+  }
+
   uint32_t get_vertex_type(uint32_t idx)  // from original idx
   {
     assert(idx >= offset);
@@ -177,19 +201,25 @@ private:
     Array::rewind();
     out->out.rewind();
 
+    // The sink states follow the regular ones here, but are indexed from zero in the mirrors.
+    uint32_t offset = sink ? locator->nregular() : 0;
+
     uint32_t rank_idx, val_idx;
     Value val;
 
     bool local = rank_meta.next(rank_idx);
     bool nonzero = Array::template advance<false>(val_idx, val);
 
+    while (nonzero and val_idx < offset)
+      nonzero = Array::template advance<false>(val_idx, val);
+
     while (local & nonzero)
     {
       uint32_t rank_idx_ = rank_idx;
-      uint32_t val_idx_ = val_idx;
+      uint32_t val_idx_ = val_idx - offset;
 
       if (rank_idx_ == val_idx_)
-        out->out.push(val_idx, val);
+        out->out.push(val_idx_, val);
       if (rank_idx_ <= val_idx_)
         local = rank_meta.next(rank_idx);
       if (rank_idx_ >= val_idx_)
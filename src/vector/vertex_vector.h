@@ -62,6 +62,8 @@ public:
 
   VertexVector(const Matrix* A) : A(A)
   {
+    Memory::Scope scope(MemoryCategory::STATES);
+
     /* Master segments, based on owned dashboards. */
     own_segs.reserve(A->dashboards.size());
 
@@ -82,8 +84,10 @@ public:
   {
     LOG.debug("Allocating mirrors (sink=%u) ... \n", sink);
 
+    Memory::Scope scope(MemoryCategory::MIRRORS);
+
     for (auto& vseg : own_segs)
-      vseg.allocate_mirrors<sink>();  // outgoing
+      vseg.template allocate_mirrors<sink>();  // outgoing
 
     MirrorSegments*& mir_segs = sink ? mir_segs_snk : mir_segs_reg;
 
@@ -99,6 +103,22 @@ public:
                                   mir_segs->num_outstanding, sink);
   }
 
+  /** (Re-)post the receives of all mirrors, once the previous ones (if any) are complete. **/
+  template <bool sink>
+  void recv_mirrors()
+  {
+    MirrorSegments* mir_segs = sink ? mir_segs_snk : mir_segs_reg;
+
+    for (uint32_t ith = 0; ith < mir_segs->blobs.size(); ith++)
+      wait_for_ith<sink>(ith);
+
+    mir_segs->requests.clear();
+    mir_segs->blobs.clear();
+    mir_segs->num_outstanding = 0;
+
+    for (auto& vseg : mir_segs->segs) vseg.recv();
+  }
+
   template <bool sink>
   void wait_for_ith(uint32_t ith)
   {
@@ -116,7 +136,8 @@ public:
       if (std::is_base_of<Serializable, typename Array::Type>::value)
         Communicable<Array>::irecv_dynamic_one(blob, request);
       MPI_Wait(&mir_segs->requests[ith], MPI_STATUSES_IGNORE);
-      mir_segs->segs[ith].irecv_postprocess(blob);
+      uint32_t nbytes = mir_segs->segs[ith].irecv_postprocess(blob);
+      if (mir_segs->segs[ith].owner != Env::rank) Env::nbytes_recvd += nbytes;
       mir_segs->blobs[ith] = nullptr;
       mir_segs->requests[ith] = MPI_REQUEST_NULL;
     }
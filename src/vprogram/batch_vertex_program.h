@@ -0,0 +1,191 @@
+#ifndef BATCH_VERTEX_PROGRAM_H
+#define BATCH_VERTEX_PROGRAM_H
+
+#include <string>
+#include "vprogram/vertex_program.h"
+
+
+/**
+ * Batched (multi-source) vertex program interface: BATCH_SIZE instances of the same vertex
+ * program (e.g., BFS from as many roots) executed at once, as lanes.
+ *
+ * Messages, accumulators and states hold one value per lane, and a mask of the lanes that hold
+ * one. Every pass over a tile thus gathers (and combines) for all lanes of each message, and a
+ * vertex is active iff it is active in any lane: many SpMVs become a single SpMM, with as many
+ * messages as the busiest lane.
+ *
+ * Override the per-lane interface below (instead of VertexProgram's), whose hooks are called
+ * for the lanes that hold a value only. init() also gets the lane (e.g., to pick its source).
+ **/
+
+template <class T, uint32_t BATCH_SIZE>
+struct Lanes
+{
+  static_assert(BATCH_SIZE > 0 and BATCH_SIZE <= 64, "BATCH_SIZE must be in [1, 64].");
+
+  uint64_t mask = 0;  // Lanes that hold a value.
+
+  T vals[BATCH_SIZE];
+
+  T& operator[](uint32_t lane) { return vals[lane]; }
+
+  const T& operator[](uint32_t lane) const { return vals[lane]; }
+
+  template <class Visitor>
+  static void for_each(uint64_t mask, Visitor visit)
+  {
+    for (; mask; mask &= mask - 1)
+      visit((uint32_t) __builtin_ctzll(mask));
+  }
+
+  static constexpr uint64_t all() { return BATCH_SIZE == 64 ? ~0ull : (1ull << BATCH_SIZE) - 1; }
+
+  // Dummy method to allow compilation (trivially serializable). Never called.
+  template <class Archive>
+  void serialize(Archive& archive, const uint32_t version) {}
+};
+
+
+template <class S, uint32_t BATCH_SIZE>
+struct LaneStates : State
+{
+  uint64_t activated = 0;  // Lanes activated by the last init() or apply().
+
+  S vals[BATCH_SIZE];
+
+  S& operator[](uint32_t lane) { return vals[lane]; }
+
+  const S& operator[](uint32_t lane) const { return vals[lane]; }
+
+  std::string to_string() const
+  {
+    std::string str = "[";
+    for (uint32_t b = 0; b < BATCH_SIZE; b++)
+      str += (b ? ", " : "") + vals[b].to_string();
+    return str + "]";
+  }
+};
+
+
+template <class W, class M, class A, class S, uint32_t BATCH_SIZE>  // <Weight, Msg, Accum, State>
+class BatchVertexProgram
+    : public VertexProgram<W, Lanes<M, BATCH_SIZE>, Lanes<A, BATCH_SIZE>,
+                           LaneStates<S, BATCH_SIZE>>
+{
+public:
+  using LaneMsg = Lanes<M, BATCH_SIZE>;
+  using LaneAccum = Lanes<A, BATCH_SIZE>;
+  using LaneState = LaneStates<S, BATCH_SIZE>;
+
+  using Base = VertexProgram<W, LaneMsg, LaneAccum, LaneState>;
+
+  static constexpr uint32_t batch_size = BATCH_SIZE;
+
+  BatchVertexProgram(const Graph<W>* G, bool stationary = false)
+      : Base(G, stationary), stationary_(stationary) {}
+
+  template <class M2, class A2>
+  BatchVertexProgram(const VertexProgram<W, M2, A2, LaneState>& other, bool stationary = false)
+      : Base(other, stationary), stationary_(stationary) {}
+
+
+  /* Overridable Per-Lane Vertex Program Interface (see VertexProgram's) */
+
+  virtual bool init(uint32_t vid, S& state, uint32_t lane) { return stationary_; }
+
+  virtual M scatter(const S& state) { return M(); }
+
+  virtual A gather(const Edge<W>& edge, const M& msg) { return A(); }
+
+  virtual A gather(const Edge<W>& edge, const M& msg, const S& state)
+  {
+    LaneState state_;
+    Base::gather(edge, LaneMsg(), state_);  // for internal use (detects override)
+    return A();
+  }
+
+  virtual void combine(const A& y1, A& y2) {}
+
+  virtual bool apply(const A& y, S& state) { return false; }
+
+  virtual bool apply(const A& y, S& state, uint32_t iter)
+  {
+    LaneState state_;
+    Base::apply(LaneAccum(), state_, iter);  // for internal use (detects override)
+    return false;
+  }
+
+
+  /* VertexProgram Interface, over the lanes */
+
+  bool init(uint32_t vid, LaneState& state)
+  {
+    state.activated = 0;
+    for (uint32_t b = 0; b < BATCH_SIZE; b++)
+      state.activated |= (uint64_t) init(vid, state[b], b) << b;
+    return state.activated != 0;
+  }
+
+  LaneMsg scatter(const LaneState& state)
+  {
+    // (Stationary apps scatter every lane, every iteration.)
+    LaneMsg msg;
+    msg.mask = stationary_ ? LaneMsg::all() : state.activated;
+    LaneMsg::for_each(msg.mask, [&](uint32_t b) { msg[b] = scatter(state[b]); });
+    return msg;
+  }
+
+  LaneAccum gather(const Edge<W>& edge, const LaneMsg& msg)
+  {
+    LaneAccum y;
+    y.mask = msg.mask;
+    LaneMsg::for_each(msg.mask, [&](uint32_t b) { y[b] = gather(edge, msg[b]); });
+    return y;
+  }
+
+  LaneAccum gather(const Edge<W>& edge, const LaneMsg& msg, const LaneState& state)
+  {
+    LaneAccum y;
+    if (msg.mask == 0)  // (Only when detecting overrides: pass it on to the per-lane one.)
+      gather(edge, msg[0], state[0]);
+    y.mask = msg.mask;
+    LaneMsg::for_each(msg.mask, [&](uint32_t b) { y[b] = gather(edge, msg[b], state[b]); });
+    return y;
+  }
+
+  void combine(const LaneAccum& y1, LaneAccum& y2)
+  {
+    LaneAccum::for_each(y1.mask, [&](uint32_t b)
+    {
+      if (y2.mask & (1ull << b))
+        combine(y1[b], y2[b]);
+      else
+        y2[b] = y1[b];
+    });
+    y2.mask |= y1.mask;
+  }
+
+  bool apply(const LaneAccum& y, LaneState& state)
+  {
+    state.activated = 0;
+    LaneAccum::for_each(y.mask, [&](uint32_t b)
+    { state.activated |= (uint64_t) apply(y[b], state[b]) << b; });
+    return state.activated != 0;
+  }
+
+  bool apply(const LaneAccum& y, LaneState& state, uint32_t iter)
+  {
+    if (y.mask == 0)  // (Only when detecting overrides: pass it on to the per-lane one.)
+      apply(y[0], state[0], iter);
+    state.activated = 0;
+    LaneAccum::for_each(y.mask, [&](uint32_t b)
+    { state.activated |= (uint64_t) apply(y[b], state[b], iter) << b; });
+    return state.activated != 0;
+  }
+
+private:
+  bool stationary_;
+};
+
+
+#endif
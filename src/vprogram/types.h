@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include "utils/common.h"
+#include "utils/enum.h"
 
 
 struct Object
@@ -26,6 +27,26 @@ struct Accum : Object { using Object::Object; };
 struct State : Object { using Object::Object; };
 
 
+class ExecutionMode : public Enum {
+public:
+  using Enum::Enum;
+  static constexpr int BSP   = 0;  // Default: bulk-synchronous iterations
+  static constexpr int ASYNC = 1;  // Asynchronous, for monotone vertex programs
+  static constexpr int PIPELINED = 2;  // BSP, each iteration's apply overlapped with the next
+
+  ExecutionMode(const char* name) : Enum(name_to_value(name, names(), 3)) {}
+
+  const char* name() const { return names()[value]; }
+
+private:
+  static const char* const* names()
+  {
+    static const char* const NAMES[] = {"bsp", "async", "pipelined"};
+    return NAMES;
+  }
+};
+
+
 template <class Weight>
 struct Edge
 {
@@ -2,12 +2,21 @@
 #define VERTEX_PROGRAM_H
 
 #include <climits>
+#include <mutex>
+#include <omp.h>
 #include <type_traits>
 #include <vector>
+#include "utils/arena.h"
+#include "utils/checkpoint.h"
+#include "utils/iteration_stats.h"
 #include "utils/env.h"
+#include "utils/lane_scheduler.h"
+#include "utils/progress_engine.h"
 #include "matrix/graph.h"
+#include "structures/bitvector.h"
 #include "structures/streaming_array.h"
 #include "structures/random_access_array.h"
+#include "structures/soa_array.h"
 #include "vector/msg_vector.h"
 #include "vector/accum_vector.h"
 #include "vector/vertex_vector.h"
@@ -42,6 +51,11 @@ public:
 
   virtual ~VertexProgram();
 
+  /** A vertex's state, as seen by the interface below: S& (or const S&), or a proxy to its fields
+      if S is stored as a struct of arrays (see StateLayout). **/
+  using StateRef      = typename StateLayout<S>::Ref;
+  using ConstStateRef = typename StateLayout<S>::ConstRef;
+
 
   /* Overridable Vertex Program Interface */
 
@@ -52,8 +66,9 @@ public:
    * For stationary apps, all vertices are activated by default regardless.
    * For efficiency, for stationary apps whose gather() depends on the state, return false
    * whenever the default state constructor is sufficient to initialize the mirrored state.
+   * May run concurrently for different vertices (from OpenMP threads): only touch vid's state.
    **/
-  virtual bool init(uint32_t vid, S& state)
+  virtual bool init(uint32_t vid, StateRef state)
   {
     //LOG.info("VertexProgram::init: Not implemented! \n");
     return stationary;
@@ -63,8 +78,9 @@ public:
    * Similar to init() but the vertex's state can be initialized using its corresponding state
    * within another vertex program that is defined on the same graph but reversed.
    * (for some examples, see Pagerank and Triangle Counting apps).
+   * May run concurrently for different vertices, like init(vid, state).
    **/
-  virtual bool init(uint32_t vid, const State& other, S& state)
+  virtual bool init(uint32_t vid, const State& other, StateRef state)
   {
     //LOG.info("VertexProgram::init2: Not implemented! \n");
     return stationary;
@@ -74,8 +90,9 @@ public:
    * Called at start of every iteration for each active vertex u.
    * x = scatter(u).  Msg x is scattered to all out-edges of u.
    * If app is stationary, then all vertices are assumed active.
+   * May run concurrently for different vertices (from OpenMP threads): only touch u's state.
    **/
-  virtual M scatter(const S& state)
+  virtual M scatter(ConstStateRef state)
   {
     //LOG.info("VertexProgram::scatter: Not implemented! \n");
     return M();
@@ -96,8 +113,9 @@ public:
    * y' = gather(e, x, v).  Returned value y' shall be combined() into v's accumulator.
    * Only use when v's state must be read during gather().
    * This will implicitly disable computation filtering optimizations.
+   * The state read is a mirror of v's, refreshed every iteration iff apply() activated v.
    **/
-  virtual A gather(const Edge<W>& edge, const M& msg, const S& state)
+  virtual A gather(const Edge<W>& edge, const M& msg, ConstStateRef state)
   {
     // LOG.info("VertexProgram::gather2: Not implemented! \n");
     gather_depends_on_state = false;  // for internal use (detects override)
@@ -107,6 +125,7 @@ public:
   /**
    * Called every iteration for each msg gathered by vertex v.
    * y = combine(y', y).  Must be associative and commutative.
+   * May run concurrently for different accumulators y (from OpenMP threads).
    **/
   virtual void combine(const A& y1, A& y2)
   {
@@ -116,8 +135,9 @@ public:
   /**
    * Called at end of every iteration for each vertex v that recvd msgs.
    * v = apply(y, v).  Return true to activate v (if state was updated).
+   * May run concurrently for different vertices (from OpenMP threads): only touch v's state.
    **/
-  virtual bool apply(const A& y, S& state)
+  virtual bool apply(const A& y, StateRef state)
   {
     //LOG.info("VertexProgram::apply: Not implemented! \n");
     return false;
@@ -128,14 +148,24 @@ public:
    * v = apply(y, v).  Return true to activate v (if state was updated).
    * Only use when apply() depends on current iteration counter.
    * This will implicitly disable computation filtering optimizations.
+   * May run concurrently for different vertices, like apply(y, v).
    **/
-  virtual bool apply(const A& y, S& state, uint32_t iter)
+  virtual bool apply(const A& y, StateRef state, uint32_t iter)
   {
     // LOG.info("VertexProgram::apply2: Not implemented! \n");
     apply_depends_on_iter = false;  // for internal use (detects override)
     return false;
   }
 
+  /**
+   * Priority of vertex v (lower first; e.g., its tentative distance) for bucketed scheduling.
+   * Only called if delta is set. May run concurrently for different vertices, like apply().
+   **/
+  virtual uint32_t priority(ConstStateRef state)
+  {
+    return 0;
+  }
+
 
   /**
    * Non-LA3-Optimizable apps should disable this flag.
@@ -147,6 +177,71 @@ public:
    **/
   bool optimizable = true;
 
+  /**
+   * Exchange messages and partial accumulators through persistent MPI requests, whose buffers
+   * are bound once (on the first call to execute()) and restarted every iteration.
+   * Only applies to trivially-serializable message and accumulator types.
+   * Regardless, co-located ranks exchange these through a SharedWindow (bound likewise), unless
+   * the execution mode exchanges them point-to-point (see mode).
+   **/
+  bool persistent = false;
+
+  /**
+   * Encode floating-point messages on the wire as 16-bit floats (ValueCodec::FLOAT16 or
+   * BFLOAT16), trading precision for bandwidth. No effect on other message types.
+   * Set before initialize(), which applies it to the initial messages on.
+   **/
+  ValueCodec message_codec = ValueCodec::NONE;
+
+  /**
+   * Run a communication progress thread during execute(), which drives the receives of
+   * messages and partial accumulators and deserializes them as they arrive (see ProgressEngine).
+   * The thread spins (MPI_Testsome, then yield) while receives are outstanding, so it takes a
+   * core from the OpenMP compute threads: best with a spare core per rank. Defaults to
+   * Env::progress_thread, i.e., $LA3_PROGRESS if set.
+   * Only applies to trivially-serializable message and accumulator types, and requires
+   * MPI_THREAD_MULTIPLE.
+   **/
+  bool progress_thread = Env::progress_thread;
+
+  /**
+   * Backend of the message and partial-accumulator exchanges. CommBackend::NEIGHBORHOOD applies
+   * to the main loop of optimizable apps only (see NeighborExchange). CommBackend::LOCAL hands
+   * what a rank sends to itself over in place, with neither serialization nor MPI (see
+   * LocalMailbox): all of it, on a single rank. Defaults to Env::backend, i.e., $LA3_BACKEND if
+   * set, else LOCAL on a single rank.
+   * Only applies to trivially-serializable message and accumulator types.
+   **/
+  CommBackend backend = Env::backend;
+
+  /**
+   * ExecutionMode::ASYNC drops the per-iteration barriers of execute() (until convergence):
+   * each rank applies and re-scatters as soon as partial accumulators arrive, and processes
+   * messages as soon as they arrive, until a counting wave detects global termination.
+   * Only valid for monotone vertex programs (e.g., min- or max-based), for which stale messages
+   * are harmless. Falls back to BSP for stationary apps, or if gather() reads the vertex state,
+   * apply() reads the iteration counter, or the graph is directed and the app not optimizable.
+   * Only applies to trivially-serializable message and accumulator types, and always exchanges
+   * them point-to-point (i.e., overrides persistent, progress_thread, and backend).
+   *
+   * ExecutionMode::PIPELINED keeps the iterations of BSP, but overlaps each with the next one:
+   * every owned segment is applied (and its messages bcast) as soon as its partial accumulators
+   * arrive, while the next iteration's messages are processed as soon as they arrive. Until
+   * convergence, one more iteration is processed (then dropped) than under BSP.
+   * Falls back to BSP for non-optimizable apps, and with delta-stepping. Only applies to
+   * trivially-serializable message and accumulator types, and always exchanges them
+   * point-to-point (i.e., overrides persistent, progress_thread, and backend).
+   **/
+  ExecutionMode mode = ExecutionMode::BSP;
+
+  /**
+   * Delta-stepping: if non-zero, activated vertices are scheduled in buckets of priority() width
+   * delta. Only those in the current bucket scatter; the others are deferred until every bucket
+   * before theirs is globally settled (i.e., an iteration activates none of its vertices).
+   * Only applies to optimizable apps executed (BSP) until convergence.
+   **/
+  uint32_t delta = 0;
+
 
   /* Vertex Program Execution Interface */
 
@@ -198,6 +293,8 @@ public:
   void activate_all();
 
   /* TODO: We only support trivially-serializable types for reduce(). */
+  /* map() and reduce() may run concurrently (from OpenMP threads), for different vertices and
+     per-thread partial values, respectively. */
   template <class Value, class Mapper, class Reducer>
   Value reduce(Mapper map, Reducer reduce, bool active_only = false);
 
@@ -209,6 +306,7 @@ public:
   void gather(std::vector<V>& values, Mapper map);*/
 
   /* TODO: We only support trivially-serializable types for topk(). */
+  /* map() may run concurrently (from OpenMP threads) for different vertices. */
   template <class I, class V, class Mapper, class Comparator>
   void topk(uint32_t k, std::vector<std::pair<I, V>>& topk, Mapper map, Comparator cmp,
             bool active_only = false);
@@ -226,10 +324,13 @@ private:
 
   using Matrix = typename Graph<W>::Matrix;
 
-  using VertexArray = Communicable<RandomAccessArray<S>>;
+  using StateArray  = typename StateLayout<S>::Array;
+  using VertexArray = Communicable<StateArray>;
   using MsgArray    = Communicable<StreamingArray<M>>;
   using AccumArray  = Communicable<RandomAccessArray<A>>;
 
+  using VertexSegment = VertexMasterSegment<Matrix, VertexArray>;
+
   using VectorV = VertexVector<Matrix, VertexArray>;
   using VectorX = MsgVector<Matrix, MsgArray>;
   using VectorY = AccumVector<Matrix, AccumArray>;
@@ -248,6 +349,20 @@ private:
 
   VectorY* y = nullptr;  /** Accumulator vector **/
 
+  /** Have x and y been bound to persistent requests (see persistent and bind())? **/
+  bool bound = false;
+
+  /** Host-shared window of the bound x and y segments, if other ranks share my host. **/
+  SharedWindow* window = nullptr;
+
+  /** Progress engine of the current execute(), if any (see progress_thread). **/
+  ProgressEngine* engine = nullptr;
+
+  /** Neighborhood exchanges of x and y, once built (see backend). **/
+  NeighborExchange* x_exchange = nullptr;
+
+  NeighborExchange* y_exchange = nullptr;
+
 
   /*
    * Specialized implementations of initialize()
@@ -275,9 +390,10 @@ private:
 
   /**
    * Execute the vertex program for given number of iterations or (by default) until convergence.
+   * If pipelined, overlap every iteration with the next one (see ExecutionMode::PIPELINED).
    **/
   template <bool mirroring>
-  void execute_(uint32_t max_iters);
+  void execute_(uint32_t max_iters, bool pipeline = false);
 
   /**
    * Execute the vertex program for given number of iterations or (by default) until convergence.
@@ -286,6 +402,12 @@ private:
   template <bool mirroring>
   void execute_non_opt(uint32_t max_iters);
 
+  /**
+   * Execute the vertex program asynchronously until convergence (see ExecutionMode::ASYNC).
+   * Sinks (if any) are then processed once, as by execute_().
+   **/
+  void execute_async();
+
   /**
    * Execute the vertex program optimized for one iteration only.
    **/
@@ -328,11 +450,101 @@ private:
 
   void initialize_flags();
 
+  /**
+   * init_one(i, vid) the vertices i in [from, from + count) of vseg, given their original IDs,
+   * in parallel if worth it: init() (and scatter()) then run concurrently for different vertices.
+   * If xseg, the messages of those activated are pushed (at i - from) from per-thread buffers,
+   * in order.
+   **/
+  template <class Init>
+  void initialize_range(VertexSegment& vseg, uint32_t from, uint32_t count, MsgArray* xseg,
+                        Init init_one);
+
+  std::vector<std::vector<std::pair<uint32_t, M>>> init_buffers;  // per thread
+
 
   /* Execution (Internal Methods) */
 
+  /**
+   * Bind persistent requests to the x and y segments (see persistent), or only to those between
+   * co-located ranks if not persistent.
+   * Collective over the ranks on each host, which exchange through a SharedWindow.
+   **/
+  void bind();
+
+  /** Start (or stop) driving the x and y receives from a progress thread (see progress_thread). **/
+  void start_progress_thread();
+
+  void stop_progress_thread();
+
+  /** Exchange x and y through neighborhood collectives (or stop doing so; see backend). **/
+  void start_neighbor_exchanges();
+
+  void stop_neighbor_exchanges();
+
+  /** Deliver what this rank sends to itself in place, from now on (or stop; see backend). **/
+  void set_local_delivery(bool local);
+
+  /**
+   * set(*x) and set(*y) (e.g., to bind them or hand them to an engine), each only if its value
+   * type is trivially serializable, which the above all require.
+   **/
+  template <class Setter>
+  void set_vectors(Setter set);
+
+  NeighborExchange*& exchange_of(const VectorX&) { return x_exchange; }
+
+  NeighborExchange*& exchange_of(const VectorY&) { return y_exchange; }
+
+  bool asynchronous() const;
+
+  bool pipelined() const;
+
   void scatter_source_messages();
 
+  /* Delta-stepping (see delta): the current bucket, and the vertices deferred to later buckets
+   * (regular only), per owned segment. */
+  uint32_t bucket = 0;
+
+  std::vector<BitVector*> deferred;
+
+  bool bucketing() const { return not deferred.empty(); }
+
+  /**
+   * Once the current bucket is globally settled, move on to the next one that has deferred
+   * vertices, if any, and scatter them as the next iteration's messages (collective).
+   * Returns false iff no vertices are deferred anymore.
+   **/
+  bool advance_bucket();
+
+  /* Checkpoints of the current execute(), if any (see Checkpoint): from the end of every
+   * Env::ckpt_every-th iteration (BSP only, without delta-stepping, of trivially-copyable or
+   * Serializable states), the states, activity and next messages of every owned segment. */
+  Checkpoint* checkpoint = nullptr;
+
+  uint32_t first_iter = 0;  // of the current execute(): after those resumed from, if any
+
+  IterationStats stats;  // of the current execute()'s iterations (BSP only)
+
+  /* Part (states = 0, activity = 1, or messages = 2) of the kth owned segment in a checkpoint. */
+  static uint32_t checkpoint_key(uint32_t kth, uint32_t part) { return 3 * kth + part; }
+
+  /** If a checkpoint was begun, add the kth owned segment's messages to it (before bcast). **/
+  void checkpoint_messages(MsgArray& xseg, uint32_t kth);
+
+  /** If a checkpoint was begun, add the states and activity to it and write it (or drop it, if
+      converged globally). **/
+  void checkpoint_iteration(bool has_converged);
+
+  /**
+   * Load the latest complete checkpoint, if any, in place of the initial states, activity and
+   * messages (collective). Returns its iteration (i.e., those already done), or 0 if none.
+   **/
+  uint32_t resume(bool mirroring);
+
+  template <bool mirroring>
+  void process_sinks(uint32_t iter);
+
   template <bool sink>
   void bcast_active_states_to_mirrors();
 
@@ -343,17 +555,34 @@ private:
   void process_messages(uint32_t iter = 0);
 
   template <bool sink, bool mirroring>
-  bool process_ready_messages(const std::vector<int32_t>& ready, uint32_t iter);
+  void process_tile(uint32_t jth, uint32_t i, uint32_t band, uint32_t iter);
 
+  /* Schedules the tiles of process_messages() over the threads (one lane per row band of each
+   * local yseg; see CSC::split()). */
+  LaneScheduler scheduler;
+
+  std::vector<uint32_t> lanes;  // The first lane of each local yseg's bands.
+
+  template <bool sink>
+  void reset_scheduler();
+
+  /** Receive the (ready) jth xseg, and schedule the bands of its tiles. **/
   template <bool sink, bool mirroring>
-  bool process_ready_messages_with_states(const std::vector<int32_t>& ready, uint32_t iter);
+  void schedule_jth_tiles(uint32_t jth, uint32_t iter);
+
+  /* Serializes the waits for mirrors, which bands of the same yseg may do at once. */
+  std::mutex mirrors_mutex;
+
+  /* Read-only, allocation-free reader of an xseg; any number may stream the same xseg at once. */
+  using MsgCursor = typename StreamingArray<M>::Cursor;
 
   template <bool gather_with_state>
   void SpMV(const CSC<W>& csc,           /** A_ith_jth **/
-            StreamingArray<M>& xseg,     /** x_jth **/
+            MsgCursor xseg,              /** x_jth **/
             RandomAccessArray<A>& yseg,  /** y_ith **/
-            RandomAccessArray<S>* vseg,  /** v_ith **/
-            uint32_t sink_offset         /** sink_offset in CSC **/);
+            StateArray* vseg,            /** v_ith **/
+            uint32_t sink_offset,        /** sink_offset in CSC **/
+            uint32_t band                /** row band of the CSC **/);
 
   /**
    * Apply final accumulated values to vertex states (for every vertex that recieved messages).
@@ -363,15 +592,82 @@ private:
   template <bool sink, bool single_iter>
   bool produce_messages(uint32_t iter = 0);
 
-  void combine_accumulators(AccumArray&, AccumFinalSegment<Matrix, AccumArray>&);
+  /**
+   * (Pipelined mode:) produce_messages() of iteration iter, overlapped with process_messages()
+   * of iteration iter + 1 (whose partial accumulators are gathered as each segment is applied).
+   * Returns true iff one or more vertices got activated in iteration iter.
+   **/
+  template <bool mirroring>
+  bool produce_and_process_messages(uint32_t iter);
+
+  /** (Pipelined mode:) drop the partial accumulators of an iteration processed ahead. **/
+  void drop_partial_accumulators();
+
+  /** Combine the jth partial (e.g., from the jth rank) as taken, in parallel if worth it. **/
+  void combine_accumulators(uint32_t jth, AccumFinalSegment<Matrix, AccumArray>&);
+
+  void combine_accumulators(const std::vector<int32_t>& ready,
+                            AccumFinalSegment<Matrix, AccumArray>&);
 
   /** Returns true iff one or more vertices got activated. **/
   template <bool sink, bool apply_with_iter, bool single_iter>
   bool apply_and_scatter_messages(AccumFinalSegment<Matrix, AccumArray>&, uint32_t iter = 0);
 
+  /**
+   * Parallel apply/scatter: threads apply the final accumulators over word-aligned chunks of
+   * their activity, buffering the messages per chunk; these are then pushed in chunk (i.e.,
+   * index) order, as the streaming xseg requires. Hence, apply(), priority() and scatter() run
+   * concurrently for the vertices of different chunks.
+   **/
+  template <bool apply_with_iter>
+  uint32_t apply_and_scatter_chunks(AccumFinalSegment<Matrix, AccumArray>&, uint32_t iter);
+
+  /* Chunks of CHUNK_NWORDS bitvector words (i.e., of 2048 vertices), for the parallel phases.
+   * Neither phase goes parallel for fewer than PARALLEL_MIN_COUNT active vertices. */
+  static constexpr uint32_t CHUNK_NWORDS = 64;
+
+  static constexpr uint32_t PARALLEL_MIN_COUNT = 4096;
+
+  /** The number of chunks to process the given activity in, or 0 to process it serially. **/
+  uint32_t num_chunks(const BitVector& activity, uint32_t count) const;
+
+  struct ChunkMessage
+  {
+    uint32_t idx;
+    bool activated;
+    M msg;
+  };
+
+  struct Chunk
+  {
+    std::vector<ChunkMessage> messages;
+    std::vector<uint32_t> deferred;  // (Delta-stepping.)
+    uint32_t nactivated;
+  };
+
+  std::vector<Chunk> chunks;  // Reused across iterations (and segments).
+
+  /** Process the jth xseg (with its source messages, if with_sources), asynchronously. **/
+  void process_jth_messages_async(uint32_t jth, bool with_sources);
+
+  /** Returns true iff one or more vertices got activated (and their messages bcast). **/
+  bool apply_and_scatter_messages_async(AccumFinalSegment<Matrix, AccumArray>&);
+
   /** (iff until_convergence:) check for global convergence. **/
   bool has_converged_globally(bool has_converged_locally, MPI_Request&);
 
+  /* Buffers of the (asynchronous) convergence vote; must outlive its MPI_Iallreduce. */
+  bool converged_locally = false, converged_globally = false;
+
+  /**
+   * (Asynchronous mode:) one wave of the termination detection, given the messages sent and
+   * recv'd so far. Call only while locally idle. Returns true iff globally terminated.
+   **/
+  bool has_terminated_globally(const uint64_t counts[2], MPI_Request&);
+
+  /* Buffers of the current wave; must outlive its MPI_Iallreduce. */
+  uint64_t wave_counts[2], wave_totals[2], last_wave_totals[2];
+
 
 public:
 
@@ -401,5 +697,7 @@ struct Edge<Empty>
 /* Implementation */
 #include "vprogram/vertex_program.hpp"
 #include "vprogram/vertex_program_execute.hpp"
+#include "vprogram/vertex_program_async.hpp"
+#include "vprogram/vertex_program_pipelined.hpp"
 
 #endif
@@ -42,9 +42,15 @@ void VertexProgram<W, M, A, S>::free()
     delete v;
   delete x;
   delete y;
+  delete window;
+  delete x_exchange;
+  delete y_exchange;
   v = nullptr;
   x = nullptr;
   y = nullptr;
+  window = nullptr;
+  x_exchange = nullptr;
+  y_exchange = nullptr;
 }
 
 
@@ -69,18 +75,70 @@ void VertexProgram<W, M, A, S>::initialize_flags()
   const Edge<W> edge = Edge<W>();
   const M msg = M();
   const A accum = A();
-  const S state = S();
+  S state = S();
   gather_depends_on_state = true;
-  gather(edge, msg, state);
+  gather(edge, msg, ConstStateRef(state));
   apply_depends_on_iter = true;
-  apply(accum, (S&) state, 0);
+  apply(accum, StateRef(state), 0);
   optimizable &= not (not G->is_directed() or gather_depends_on_state or apply_depends_on_iter);
   initialized = true;
+
+  set_local_delivery(backend == CommBackend::LOCAL);
+
+  // Senders and receivers agree on it, from the initial messages on.
+  for (auto& xseg : x->outgoing.regular) xseg.set_value_codec(message_codec);
+  for (auto& xseg : x->outgoing.source)  xseg.set_value_codec(message_codec);
+  for (auto& xseg : x->incoming.regular) xseg.set_value_codec(message_codec);
+  for (auto& xseg : x->incoming.source)  xseg.set_value_codec(message_codec);
+
+  for (auto& vseg : v->own_segs) vseg.map_original_ids(G->get_hasher());
   LOG.debug("optimizable %u, gather_depends_on_state %u, apply_depends_on_iter %u \n",
             optimizable, gather_depends_on_state, apply_depends_on_iter);
 }
 
 
+template <class W, class M, class A, class S>
+template <class Init>
+void VertexProgram<W, M, A, S>::initialize_range(VertexSegment& vseg, uint32_t from,
+                                                 uint32_t count, MsgArray* xseg, Init init_one)
+{
+  const uint32_t* ids = vseg.original_ids;
+
+  if (count < PARALLEL_MIN_COUNT or omp_get_max_threads() == 1)
+  {
+    for (auto i_ = 0u; i_ < count; i_++)
+    {
+      auto i = from + i_;
+      if (init_one(i, ids[i]) and xseg)
+        xseg->push(i_, scatter(vseg[i]));
+    }
+    return;
+  }
+
+  init_buffers.resize(omp_get_max_threads());
+  for (auto& buffer : init_buffers) buffer.clear();
+
+  // Static scheduling: one contiguous block per thread, in thread order.
+  #pragma omp parallel
+  {
+    auto& buffer = init_buffers[omp_get_thread_num()];
+
+    #pragma omp for schedule(static)
+    for (auto i_ = 0u; i_ < count; i_++)
+    {
+      auto i = from + i_;
+      if (init_one(i, ids[i]) and xseg)
+        buffer.emplace_back(i_, scatter(vseg[i]));
+    }
+  }
+
+  if (xseg)
+    for (auto& buffer : init_buffers)
+      for (auto& message : buffer)
+        xseg->push(message.first, message.second);
+}
+
+
 template <class W, class M, class A, class S>
 void VertexProgram<W, M, A, S>::initialize()
 {
@@ -98,16 +156,9 @@ void VertexProgram<W, M, A, S>::initialize()
 
     assert(xseg.size() == vseg.locator->nregular());
 
-    for (auto i = 0u; i < xseg.size(); i++)
-    {
-      uint32_t hidx = vseg.offset + vseg.original_from_internal_map[i];
-      uint32_t idx = (uint32_t) G->get_hasher()->unhash(hidx);
-      if (init(idx, vseg[i]))
-      {
-        //vseg.activity->push(i);
-        xseg.push(i, scatter(vseg[i]));
-      }
-    }
+    auto init_one = [&](uint32_t i, uint32_t idx) { return init(idx, vseg[i]); };
+
+    initialize_range(vseg, 0, xseg.size(), &xseg, init_one);
 
     xseg.bcast();
 
@@ -115,27 +166,14 @@ void VertexProgram<W, M, A, S>::initialize()
     {
       // Sink
 
-      for (auto i_ = 0u; i_ < vseg.locator->nsink(); i_++)
-      {
-        auto i = vseg.locator->nregular() + i_;
-        uint32_t idx = vseg.offset + vseg.original_from_internal_map[i];
-        idx = (uint32_t) G->get_hasher()->unhash(idx);
-        if (init(idx, vseg[i]))
-          ; //vseg.activity->push(i);
-      }
+      initialize_range(vseg, vseg.locator->nregular(), vseg.locator->nsink(), nullptr, init_one);
 
       // Source
 
       assert(xseg_.size() == vseg.locator->nsource());
 
-      for (auto i_ = 0u; i_ < xseg_.size(); i_++)
-      {
-        auto i = vseg.locator->nregular() + vseg.locator->nsink() + i_;
-        uint32_t idx = vseg.offset + vseg.original_from_internal_map[i];
-        idx = (uint32_t) G->get_hasher()->unhash(idx);
-        if (init(idx, vseg[i]))
-          xseg_.push(i_, scatter(vseg[i]));
-      }
+      initialize_range(vseg, vseg.locator->nregular() + vseg.locator->nsink(), xseg_.size(),
+                       &xseg_, init_one);
 
       xseg_.bcast();
     }
@@ -145,15 +183,7 @@ void VertexProgram<W, M, A, S>::initialize()
     uint32_t isolated_offset
         = vseg.locator->nregular() + vseg.locator->nsink() + vseg.locator->nsource();
 
-    uint32_t nisolated = vseg.size() - isolated_offset;
-
-    for (auto i_ = 0u; i_ < nisolated; i_++)
-    {
-      auto i = isolated_offset + i_;
-      uint32_t hidx = vseg.offset + vseg.original_from_internal_map[i];
-      uint32_t idx = (uint32_t) G->get_hasher()->unhash(hidx);
-      init(idx, vseg[i]);
-    }
+    initialize_range(vseg, isolated_offset, vseg.size() - isolated_offset, nullptr, init_one);
   }
 
   if (gather_depends_on_state and not v->mirrors_allocated)
@@ -278,21 +308,20 @@ void VertexProgram<W, M, A, S>::initialize_bipartite_directed()
 
   for (auto& xseg : x->incoming.source) xseg.recv();
 
+  uint32_t nleft = G->get_nvertices_left();
+
   for (auto& vseg : v->own_segs)
   {
+    auto init_one = [&](uint32_t i, uint32_t idx)
+    {
+      if ((left and idx <= nleft) or (right and idx > nleft))
+        return init(idx, vseg[i]);
+      return false;
+    };
+
     // Sink
 
-    for (auto i_ = 0u; i_ < vseg.locator->nsink(); i_++)
-    {
-      auto i = vseg.locator->nregular() + i_;
-      uint32_t idx = vseg.offset + vseg.original_from_internal_map[i];
-      idx = (uint32_t) G->get_hasher()->unhash(idx);
-      if ((left and idx <= G->get_nvertices_left()) or (right and idx > G->get_nvertices_left()))
-      {
-        if (init(idx, vseg[i]))
-          ; //vseg.activity->push(i);
-      }
-    }
+    initialize_range(vseg, vseg.locator->nregular(), vseg.locator->nsink(), nullptr, init_one);
 
     // Source
 
@@ -300,17 +329,8 @@ void VertexProgram<W, M, A, S>::initialize_bipartite_directed()
 
     assert(xseg_.size() == vseg.locator->nsource());
 
-    for (auto i_ = 0u; i_ < xseg_.size(); i_++)
-    {
-      auto i = vseg.locator->nregular() + vseg.locator->nsink() + i_;
-      uint32_t idx = vseg.offset + vseg.original_from_internal_map[i];
-      idx = (uint32_t) G->get_hasher()->unhash(idx);
-      if ((left and idx <= G->get_nvertices_left()) or (right and idx > G->get_nvertices_left()))
-      {
-        if (init(idx, vseg[i]))
-          xseg_.push(i_, scatter(vseg[i]));
-      }
-    }
+    initialize_range(vseg, vseg.locator->nregular() + vseg.locator->nsink(), xseg_.size(),
+                     &xseg_, init_one);
 
     xseg_.bcast();
 
@@ -319,16 +339,7 @@ void VertexProgram<W, M, A, S>::initialize_bipartite_directed()
     uint32_t isolated_offset
         = vseg.locator->nregular() + vseg.locator->nsink() + vseg.locator->nsource();
 
-    uint32_t nisolated = vseg.size() - isolated_offset;
-
-    for (auto i_ = 0u; i_ < nisolated; i_++)
-    {
-      auto i = isolated_offset + i_;
-      uint32_t hidx = vseg.offset + vseg.original_from_internal_map[i];
-      uint32_t idx = (uint32_t) G->get_hasher()->unhash(hidx);
-      if ((left and idx <= G->get_nvertices_left()) or (right and idx > G->get_nvertices_left()))
-        init(idx, vseg[i]);
-    }
+    initialize_range(vseg, isolated_offset, vseg.size() - isolated_offset, nullptr, init_one);
   }
 
   if (gather_depends_on_state and not v->mirrors_allocated)
@@ -355,27 +366,24 @@ void VertexProgram<W, M, A, S>::initialize_bipartite_undirected()
 
   for (auto& xseg : x->incoming.regular) xseg.recv();
 
+  uint32_t nleft = G->get_nvertices_left();
+
   for (auto& vseg : v->own_segs)
   {
     auto& xseg = x->outgoing.regular[vseg.kth];
 
+    auto init_one = [&](uint32_t i, uint32_t idx)
+    {
+      if ((left and idx <= nleft) or (right and idx > nleft))
+        return init(idx, vseg[i]);
+      return false;
+    };
+
     // Regular
 
     assert(xseg.size() == vseg.locator->nregular());
 
-    for (auto i = 0u; i < xseg.size(); i++)
-    {
-      uint32_t hidx = vseg.offset + vseg.original_from_internal_map[i];
-      uint32_t idx = (uint32_t) G->get_hasher()->unhash(hidx);
-      if ((left and idx <= G->get_nvertices_left()) or (right and idx > G->get_nvertices_left()))
-      {
-        if (init(idx, vseg[i]))
-        {
-          ; //vseg.activity->push(i);
-          xseg.push(i, scatter(vseg[i]));
-        }
-      }
-    }
+    initialize_range(vseg, 0, xseg.size(), &xseg, init_one);
 
     xseg.bcast();
 
@@ -384,16 +392,7 @@ void VertexProgram<W, M, A, S>::initialize_bipartite_undirected()
     uint32_t isolated_offset
         = vseg.locator->nregular() + vseg.locator->nsink() + vseg.locator->nsource();
 
-    uint32_t nisolated = vseg.size() - isolated_offset;
-
-    for (auto i_ = 0u; i_ < nisolated; i_++)
-    {
-      auto i = isolated_offset + i_;
-      uint32_t hidx = vseg.offset + vseg.original_from_internal_map[i];
-      uint32_t idx = (uint32_t) G->get_hasher()->unhash(hidx);
-      if ((left and idx <= G->get_nvertices_left()) or (right and idx > G->get_nvertices_left()))
-        init(idx, vseg[i]);
-    }
+    initialize_range(vseg, isolated_offset, vseg.size() - isolated_offset, nullptr, init_one);
   }
 
   if (gather_depends_on_state and not v->mirrors_allocated)
@@ -428,18 +427,16 @@ void VertexProgram<W, M, A, S>::initialize(const VertexProgram<W2, M2, A2, S2>&
     auto& xseg = x->outgoing.regular[vseg.kth];
     auto& xseg_ = x->outgoing.source[vseg.kth];
 
+    auto& other_vseg = other.get_vector_v()->own_segs[vseg.kth];
+
+    uint32_t nregular = vseg.locator->nregular();
+    uint32_t nsink = vseg.locator->nsink();
+    uint32_t nsource = vseg.locator->nsource();
+
     // Regular
 
-    for (auto i = 0u; i < xseg.size(); i++)
-    {
-      uint32_t hidx = vseg.offset + vseg.original_from_internal_map[i];
-      uint32_t idx = (uint32_t) G->get_hasher()->unhash(hidx);
-      if (init(idx, (other.get_vector_v()->own_segs[vseg.kth][i]), vseg[i]))
-      {
-        ; //vseg.activity->push(i);
-        xseg.push(i, scatter(vseg[i]));
-      }
-    }
+    initialize_range(vseg, 0, xseg.size(), &xseg, [&](uint32_t i, uint32_t idx)
+    { return init(idx, other_vseg[i], vseg[i]); });
 
     xseg.bcast();
 
@@ -447,47 +444,25 @@ void VertexProgram<W, M, A, S>::initialize(const VertexProgram<W2, M2, A2, S2>&
     {
       // Sink
 
-      for (auto i_ = 0u; i_ < vseg.locator->nsink(); i_++)
-      {
-        auto i = vseg.locator->nregular() + i_;
-        auto j = vseg.locator->nregular() + vseg.locator->nsource() + i_;
-        uint32_t idx = vseg.offset + vseg.original_from_internal_map[i];
-        idx = (uint32_t) G->get_hasher()->unhash(idx);
-        if (init(idx, (other.get_vector_v()->own_segs[vseg.kth][j]), vseg[i]))
-          ; //vseg.activity->push(i);
-      }
+      initialize_range(vseg, nregular, nsink, nullptr, [&](uint32_t i, uint32_t idx)
+      { return init(idx, other_vseg[i + nsource], vseg[i]); });
 
       // Source
 
-      assert(xseg_.size() == vseg.locator->nsource());
+      assert(xseg_.size() == nsource);
 
-      for (auto i_ = 0u; i_ < xseg_.size(); i_++)
-      {
-        auto j = vseg.locator->nregular() + i_;
-        auto i = vseg.locator->nregular() + vseg.locator->nsink() + i_;
-        uint32_t idx = vseg.offset + vseg.original_from_internal_map[i];
-        idx = (uint32_t) G->get_hasher()->unhash(idx);
-        if (init(idx, (other.get_vector_v()->own_segs[vseg.kth][j]), vseg[i]))
-          xseg_.push(i_, scatter(vseg[i]));
-      }
+      initialize_range(vseg, nregular + nsink, xseg_.size(), &xseg_, [&](uint32_t i, uint32_t idx)
+      { return init(idx, other_vseg[i - nsink], vseg[i]); });
 
       xseg_.bcast();
     }
 
     // Isolated
 
-    uint32_t isolated_offset
-        = vseg.locator->nregular() + vseg.locator->nsink() + vseg.locator->nsource();
-
-    uint32_t nisolated = vseg.size() - isolated_offset;
+    uint32_t isolated_offset = nregular + nsink + nsource;
 
-    for (auto i_ = 0u; i_ < nisolated; i_++)
-    {
-      auto i = isolated_offset + i_;
-      uint32_t hidx = vseg.offset + vseg.original_from_internal_map[i];
-      uint32_t idx = (uint32_t) G->get_hasher()->unhash(hidx);
-      init(idx, (other.get_vector_v()->own_segs[vseg.kth][i]), vseg[i]);
-    }
+    initialize_range(vseg, isolated_offset, vseg.size() - isolated_offset, nullptr,
+                     [&](uint32_t i, uint32_t idx) { return init(idx, other_vseg[i], vseg[i]); });
   }
 
   if (gather_depends_on_state and not v->mirrors_allocated)
@@ -560,33 +535,39 @@ template <class W, class M, class A, class S>
 template <class Value, class Mapper, class Reducer>
 Value VertexProgram<W, M, A, S>::reduce(Mapper map, Reducer reduce, bool active_only)
 {
-  Value r = Value();
+  // Per thread, then in thread order (hence, the reducer is to be associative anyway).
+  std::vector<Value> rs(omp_get_max_threads(), Value());
 
   for (auto& vseg : v->own_segs)
   {
+    const uint32_t* ids = vseg.original_ids;
+
+    bool parallel = (active_only ? vseg.activity->count() : vseg.size()) >= PARALLEL_MIN_COUNT;
+
     if (active_only)
     {
-      vseg.rewind();
-      uint32_t idx = 0;
-      S val = S();
-      while (vseg.next(idx, val))
+      uint32_t nchunks = (vseg.activity->get_nwords() + CHUNK_NWORDS - 1) / CHUNK_NWORDS;
+
+      #pragma omp parallel for schedule(static) if (parallel)
+      for (uint32_t c = 0; c < nchunks; c++)
       {
-        idx = vseg.offset + vseg.original_from_internal_map[idx];
-        idx = (uint32_t) G->get_hasher()->unhash(idx);
-        reduce(r, map(idx, val));
+        Value& r = rs[omp_get_thread_num()];
+        vseg.activity->for_each(c * CHUNK_NWORDS, (c + 1) * CHUNK_NWORDS,
+                                [&](uint32_t i) { reduce(r, map(ids[i], vseg[i])); });
       }
     }
     else
     {
+      #pragma omp parallel for schedule(static) if (parallel)
       for (uint32_t i = 0; i < vseg.size(); i++)
-      {
-        uint32_t idx = vseg.offset + vseg.original_from_internal_map[i];
-        idx = (uint32_t) G->get_hasher()->unhash(idx);
-        reduce(r, map(idx, vseg[i]));
-      }
+        reduce(rs[omp_get_thread_num()], map(ids[i], vseg[i]));
     }
   }
 
+  Value r = Value();
+  for (auto& r_ : rs)
+    reduce(r, r_);
+
   Value final_v = Value();
   std::vector<Value> collection(Env::is_master ? (Env::nranks) : 0);
 
@@ -615,29 +596,39 @@ void VertexProgram<W, M, A, S>::topk(uint32_t k, std::vector<std::pair<I, V>>& t
 
   topk.clear();
 
-  // Step 1: Create index-value pairs (own)
+  // Step 1: Create index-value pairs (own), per thread, then concatenated in thread order (as
+  //         static scheduling hands each thread one contiguous block, this is vertex order).
+  std::vector<std::vector<iv_t>> ivs_(omp_get_max_threads());
+
   for (auto& vseg : v->own_segs)
   {
+    const uint32_t* ids = vseg.original_ids;
+
+    bool parallel = (active_only ? vseg.activity->count() : vseg.size()) >= PARALLEL_MIN_COUNT;
+
     if (active_only)
     {
-      vseg.rewind();
-      I idx = 0;
-      S val = S();
-      while (vseg.next(idx, val))
+      uint32_t nchunks = (vseg.activity->get_nwords() + CHUNK_NWORDS - 1) / CHUNK_NWORDS;
+
+      #pragma omp parallel for schedule(static) if (parallel)
+      for (uint32_t c = 0; c < nchunks; c++)
       {
-        idx = vseg.offset + vseg.original_from_internal_map[idx];
-        idx = (uint32_t) G->get_hasher()->unhash(idx);
-        ivs.push_back(iv_t(idx, map(idx, val)));
+        auto& ivs_t = ivs_[omp_get_thread_num()];
+        vseg.activity->for_each(c * CHUNK_NWORDS, (c + 1) * CHUNK_NWORDS, [&](uint32_t i)
+        { ivs_t.push_back(iv_t(ids[i], map(ids[i], vseg[i]))); });
       }
     }
     else
     {
+      #pragma omp parallel for schedule(static) if (parallel)
       for (uint32_t i = 0; i < vseg.size(); i++)
-      {
-        uint32_t idx = vseg.offset + vseg.original_from_internal_map[i];
-        idx = (uint32_t) G->get_hasher()->unhash(idx);
-        ivs.push_back(iv_t(idx, map(idx, vseg[i])));
-      }
+        ivs_[omp_get_thread_num()].push_back(iv_t(ids[i], map(ids[i], vseg[i])));
+    }
+
+    for (auto& ivs_t : ivs_)
+    {
+      ivs.insert(ivs.end(), ivs_t.begin(), ivs_t.end());
+      ivs_t.clear();
     }
   }
 
@@ -703,8 +694,7 @@ void VertexProgram<W, M, A, S>::btopk(uint32_t k, std::vector<std::pair<I, V>>*
       S val = S();
       while (vseg.next(idx, val))
       {
-        idx = vseg.offset + vseg.original_from_internal_map[idx];
-        idx = (uint32_t) G->get_hasher()->unhash(idx);
+        idx = vseg.original_ids[idx];
         V* vals = map(idx, val);
         for (auto b = 0; b < BATCH_SIZE; b++)
           ivs[b].push_back(iv_t(idx, vals[b]));
@@ -714,8 +704,7 @@ void VertexProgram<W, M, A, S>::btopk(uint32_t k, std::vector<std::pair<I, V>>*
     {
       for (uint32_t i = 0; i < vseg.size(); i++)
       {
-        uint32_t idx = vseg.offset + vseg.original_from_internal_map[i];
-        idx = (uint32_t) G->get_hasher()->unhash(idx);
+        uint32_t idx = vseg.original_ids[i];
         V* vals = map(idx, vseg[i]);
         for (auto b = 0; b < BATCH_SIZE; b++)
           ivs[b].push_back(iv_t(idx, vals[b]));
@@ -0,0 +1,253 @@
+/*
+ * Vertex program implementation - asynchronous execute() (see ExecutionMode::ASYNC).
+ */
+
+#ifndef VERTEX_PROGRAM_ASYNC_HPP
+#define VERTEX_PROGRAM_ASYNC_HPP
+
+//#include "vprogram/vertex_program.h"
+
+
+template <class W, class M, class A, class S>
+bool VertexProgram<W, M, A, S>::asynchronous() const
+{
+  if (mode != ExecutionMode::ASYNC)
+    return false;
+
+  bool valid = not stationary and not gather_depends_on_state and not apply_depends_on_iter
+               and (optimizable or not G->is_directed())
+               and not std::is_base_of<Serializable, M>::value
+               and not std::is_base_of<Serializable, A>::value;
+
+  if (not valid)
+    LOG.warn("Asynchronous mode does not apply to this vertex program: executing BSP. \n");
+
+  return valid;
+}
+
+
+/**
+ * Every rank loops over its receives, without ever blocking: it processes each xseg as soon as
+ * it arrives (re-posting its receive right away), sends its partial accumulators, and combines
+ * each partial that arrives, applying the final accumulators and bcast'ing the messages of the
+ * vertices they activate. A send that would have to wait for the previous one on the same
+ * segment is deferred instead (its accumulators keep combining meanwhile), which leaves no
+ * cycle of ranks waiting on each other's receives.
+ *
+ * Termination: whenever idle, a rank takes part in a wave that sums the messages (and partials)
+ * sent and recv'd by all ranks. Once two consecutive waves find the same totals, with as many
+ * recv'd as sent, none are in flight and none will be (the four-counter method).
+ **/
+template <class W, class M, class A, class S>
+void VertexProgram<W, M, A, S>::execute_async()
+{
+  /* Initial Scatter */
+  if (G->is_directed()) scatter_source_messages();
+
+  DistTimer async_timer("Asynchronous Processing");
+  LOG.info("Executing Asynchronously \n");
+
+  // Sent and recv'd so far. The messages scattered by initialize() (i.e., the first xseg of
+  // every column group) are counted on neither end.
+  uint64_t counts[2] = {0, 0};
+  last_wave_totals[0] = last_wave_totals[1] = UINT64_MAX;
+  MPI_Request wave_req = MPI_REQUEST_NULL;
+
+  std::vector<bool> initial(x->incoming.regular.size(), true);
+
+  if (x->blobs.empty())  // Nothing scattered by initialize(): just the source messages, if any.
+  {
+    for (auto& xseg : x->incoming.regular)
+    {
+      process_jth_messages_async(xseg.jth, true);
+      initial[xseg.jth] = false;
+    }
+    for (auto& xseg : x->incoming.regular) xseg.recv();
+  }
+
+  for (auto& yseg : y->own_segs) yseg.gather();
+
+  bool terminated = false;
+
+  while (not terminated)
+  {
+    bool idle = true;
+
+    /* Messages -> partial accumulators */
+    for (auto jth : *x->test_for_some())
+    {
+      x->irecv_postprocess(jth);
+      process_jth_messages_async(jth, initial[jth]);  // (Source messages with the first only.)
+      counts[1] += not initial[jth];
+      initial[jth] = false;
+
+      x->incoming.regular[jth].recv();
+      idle = false;
+    }
+
+    for (auto& yseg : y->local_segs)
+    {
+      if (yseg.activity->count() == 0)
+        continue;
+
+      if (yseg.sent())
+      {
+        yseg.send();
+        counts[0]++;
+      }
+      else
+        idle = false;
+    }
+
+    /* Partial accumulators -> final accumulators -> vertex states -> messages */
+    for (auto& final_yseg : y->own_segs)
+    {
+      for (auto jth : final_yseg.test_for_some())
+      {
+        combine_accumulators(jth, final_yseg);
+        final_yseg.regather(jth);
+        counts[1]++;
+        idle = false;
+      }
+
+      if (final_yseg.activity->count() == 0)
+        continue;
+
+      auto& xseg = x->outgoing.regular[final_yseg.kth];
+
+      if (xseg.sent())
+      {
+        if (apply_and_scatter_messages_async(final_yseg))
+          counts[0] += xseg.nranks();
+      }
+      else
+        idle = false;
+    }
+
+    if (idle)
+      terminated = has_terminated_globally(counts, wave_req);
+  }
+
+  /* No more messages are due: withdraw the receives, before any rank sends again. */
+  x->cancel();
+  for (auto& yseg : y->own_segs) yseg.cancel();
+
+  Env::barrier();
+
+  for (auto& xseg: x->outgoing.regular) xseg.postprocess();
+  for (auto& yseg: y->local_segs) yseg.postprocess();
+
+  async_timer.stop();
+
+  /* Sink Processing */
+  if (G->is_directed())
+  {
+    process_sinks<false>(0);
+
+    for (auto& xseg: x->outgoing.regular) xseg.postprocess();
+    for (auto& yseg: y->local_segs_sink) yseg.postprocess();
+  }
+
+  LOG.debug("Done with execute() \n");
+}
+
+
+template <class W, class M, class A, class S>
+void VertexProgram<W, M, A, S>::process_jth_messages_async(uint32_t jth, bool with_sources)
+{
+  StreamingArray<M>& xseg = x->incoming.regular[jth];  // Regular messages
+  StreamingArray<M>& xseg_ = x->incoming.source[jth];  // Source messages
+
+  auto& colgrp = G->get_matrix()->local_colgrps[jth];
+
+  auto& ysegs = y->local_segs;
+
+  xseg.rewind();
+  xseg_.rewind();
+
+  // One (yseg, row band) pair per iteration.
+  std::vector<std::pair<uint32_t, uint32_t>> bands;
+  for (uint32_t i = 0; i < ysegs.size(); i++)
+    for (uint32_t b = 0; b < ysegs[i].nbands; b++)
+      bands.emplace_back(i, b);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (uint32_t k = 0; k < bands.size(); k++)
+  {
+    auto& yseg = ysegs[bands[k].first];
+    auto& csc = *colgrp.local_tiles[yseg.ith]->csc;
+    uint32_t band = bands[k].second;
+
+    // Source messages -> Regular vertices
+    if (with_sources)
+      SpMV<false>(csc, xseg_.cursor(), yseg, nullptr, xseg.size(), band);
+    // Regular messages -> Regular vertices
+    SpMV<false>(csc, xseg.cursor(), yseg, nullptr, 0, band);
+  }
+}
+
+
+template <class W, class M, class A, class S>
+bool VertexProgram<W, M, A, S>::apply_and_scatter_messages_async(
+    AccumFinalSegment<Matrix, AccumArray>& final_yseg)
+{
+  bool any_activated = false;
+
+  auto& vseg = v->own_segs[final_yseg.kth];
+
+  auto& xseg = x->outgoing.regular[final_yseg.kth];
+
+  final_yseg.rewind();
+
+  uint32_t idx;
+  A yval;
+
+  while (final_yseg.pop(idx, yval))
+  {
+    if (apply(yval, vseg[idx]))
+    {
+      any_activated = true;
+      vseg.activity->push(idx);
+      xseg.push(idx, scatter(vseg[idx]));
+    }
+  }
+
+  if (any_activated)
+    xseg.bcast();
+
+  return any_activated;
+}
+
+
+template <class W, class M, class A, class S>
+bool VertexProgram<W, M, A, S>::has_terminated_globally(
+    const uint64_t counts[2], MPI_Request& wave_req)
+{
+  // Start the next wave.
+  if (wave_req == MPI_REQUEST_NULL)
+  {
+    wave_counts[0] = counts[0];
+    wave_counts[1] = counts[1];
+    MPI_Iallreduce(wave_counts, wave_totals, 2, MPI_UINT64_T, MPI_SUM, Env::MPI_WORLD,
+                   &wave_req);
+    return false;
+  }
+
+  int done;
+  MPI_Test(&wave_req, &done, MPI_STATUS_IGNORE);
+  if (not done)
+    return false;
+
+  // (All ranks see the same totals, hence reach the same decision in the same wave.)
+  bool terminated = wave_totals[0] == wave_totals[1]
+                    and wave_totals[0] == last_wave_totals[0]
+                    and wave_totals[1] == last_wave_totals[1];
+
+  last_wave_totals[0] = wave_totals[0];
+  last_wave_totals[1] = wave_totals[1];
+
+  return terminated;
+}
+
+
+#endif
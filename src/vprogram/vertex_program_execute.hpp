@@ -15,9 +15,44 @@ void VertexProgram<W, M, A, S>::execute(uint32_t max_iters)
   if (not initialized)
     initialize();
 
+  const bool async = max_iters == UNTIL_CONVERGENCE and asynchronous();
+
+  const bool pipeline = max_iters != 1 and pipelined();
+
+  // (Both modes may send a segment again before the previous one is consumed.)
+  const bool p2p_only = async or pipeline;
+
+  set_local_delivery(backend == CommBackend::LOCAL and not p2p_only);
+
+  if ((persistent or Env::node_nranks > 1) and not p2p_only)
+    bind();
+
+  if (progress_thread and not p2p_only)
+    start_progress_thread();
+
   const bool mirroring = gather_depends_on_state and not disable_mirroring;
 
-  if (max_iters == 1)
+  if (Checkpoint::enabled() and max_iters != 1)
+  {
+    if (async or pipeline or (delta and max_iters == UNTIL_CONVERGENCE))
+      LOG.warn("Checkpoints do not apply to this execution mode: none taken. \n");
+    // States are saved as a blob (see checkpoint_iteration()): bytewise, unless Serializable.
+    else if (not std::is_trivially_copyable<S>::value
+             and not std::is_base_of<Serializable, S>::value)
+      LOG.warn("Checkpoints do not apply to states that are neither trivially copyable nor "
+               "Serializable: none taken. \n");
+    else
+    {
+      checkpoint = new Checkpoint();
+      if (Env::resume)
+        first_iter = resume(mirroring);
+    }
+  }
+
+  if (async)
+    execute_async();
+
+  else if (max_iters == 1)
   {
     if (G->is_directed())
     {
@@ -34,8 +69,8 @@ void VertexProgram<W, M, A, S>::execute(uint32_t max_iters)
   {
     if (optimizable)
     {
-      if (mirroring) execute_<true>(max_iters);
-      else execute_<false>(max_iters);
+      if (mirroring) execute_<true>(max_iters, pipeline);
+      else execute_<false>(max_iters, pipeline);
     }
     else
     {
@@ -44,6 +79,14 @@ void VertexProgram<W, M, A, S>::execute(uint32_t max_iters)
     }
   }
 
+  stop_progress_thread();
+
+  stats.report();
+
+  delete checkpoint;  // (Once complete, its checkpoints are removed.)
+  checkpoint = nullptr;
+  first_iter = 0;
+
   /* Cleanup *
   delete x;
   delete y;
@@ -54,11 +97,14 @@ void VertexProgram<W, M, A, S>::execute(uint32_t max_iters)
 
 template <class W, class M, class A, class S>
 template <bool mirroring>
-void VertexProgram<W, M, A, S>::execute_(uint32_t max_iters)
+void VertexProgram<W, M, A, S>::execute_(uint32_t max_iters, bool pipeline)
 {
   /* Initial Scatter */
   scatter_source_messages();
 
+  if (backend == CommBackend::NEIGHBORHOOD and not pipeline)
+    start_neighbor_exchanges();
+
   /* Mirror active vertex states (moved this to initialize())
   if (mirroring)
   {
@@ -68,60 +114,95 @@ void VertexProgram<W, M, A, S>::execute_(uint32_t max_iters)
   } */
 
   /* Main Loop (Regular Processing) */
-  uint32_t iter = 0;
+  uint32_t iter = first_iter;
   bool until_convergence = max_iters == UNTIL_CONVERGENCE;
   bool has_converged = false;
   MPI_Request convergence_req = MPI_REQUEST_NULL;
 
+  if (delta and until_convergence)
+  {
+    bucket = 0;
+    for (auto& xseg : x->outgoing.regular)
+      deferred.push_back(new BitVector(xseg.size()));
+  }
+
   while (until_convergence ? not has_converged : iter < max_iters)
   {
     DistTimer it_timer("Iteration " + std::to_string(iter + 1));
     LOG.info("Executing Iteration %u\n", iter + 1);
+    stats.begin(iter);
 
     /*
-     * TODO: currently we mirror the states only ONCE at the start.
-     * Mirroring them every iteration will be extremely expensive and currently we do not know of
-     * any apps that require that anyway. It would be required only when gather() depends on
-     * all or part of the vertex state that is dynamic, i.e., modified across iterations.
+     * The states are mirrored in full once, by initialize(). Since then, only those of the
+     * vertices that apply() activated may have changed: refresh their mirrors only (the
+     * vertex activity accumulates them between refreshes).
      */
-    // if (mirroring and iter > 0)
-    // {
-    //   for (auto& vseg: v->own_segs) vseg.postprocess();  // Cleanup
-    //   bcast_active_states_to_mirrors<false>();  // Regular
-    //   reset_activity();  // Vertex activity need only be maintained for mirroring.
-    // }
+    if (mirroring and iter > 0)
+    {
+      bcast_active_states_to_mirrors<false>();  // Regular
+      reset_activity();  // Vertex activity need only be maintained for mirroring.
+    }
+    stats.exchanged(IterationStat::MIRRORS_BYTES, IterationStat::MIRRORS_RECVD);
 
-    /* Request the current iteration's partial accumulators. */
-    for (auto& yseg : y->own_segs) yseg.gather();
+    // (Pipelined: the current iteration's messages were processed along the previous one's.)
+    if (not pipeline or iter == 0)
+    {
+      /* Request the current iteration's partial accumulators. */
+      for (auto& yseg : y->own_segs) yseg.gather();
 
-    process_messages<false, mirroring>(iter);
+      process_messages<false, mirroring>(iter);
+      y->flush();
+    }
+    stats.exchanged(IterationStat::PROCESSING_BYTES, IterationStat::PROCESSING_RECVD);
 
     /* Request the next iteration's messages. */
     for (auto& xseg : x->incoming.regular) xseg.recv();
+    x->track();
+
+    if (checkpoint and checkpoint->due(iter + 1) and (until_convergence or iter + 1 < max_iters))
+      checkpoint->begin(iter + 1);
+
+    if (pipeline and (until_convergence or iter + 1 < max_iters))
+    {
+      has_converged = not produce_and_process_messages<mirroring>(iter);
+      y->flush();
+    }
+    else
+      has_converged = not produce_messages<false, false>(iter);
 
-    has_converged = not produce_messages<false, false>(iter);
+    x->flush();
+    stats.exchanged(IterationStat::PRODUCING_BYTES, IterationStat::PRODUCING_RECVD);
 
     if (until_convergence)
       has_converged = has_converged_globally(has_converged, convergence_req);
 
+    if (has_converged and bucketing())
+      has_converged = not advance_bucket();
+
+    stats.end();
     it_timer.stop();
 
     iter++;
+
+    if (checkpoint)
+      checkpoint_iteration(until_convergence and has_converged);  // (Else, only local.)
   }
 
   /* Final Wait (Regular Processing) */
   DistTimer final_wait_timer("Final Wait");
   LOG.debug("Final Wait \n");
 
-  do { x->wait_for_some(); }
-  while (not x->no_more_segs_then_clear());
+  x->drain();
+
+  if (pipeline and until_convergence)
+    drop_partial_accumulators();  // (Of the iteration processed ahead of convergence.)
+
+  stop_neighbor_exchanges();  // The rest is point-to-point.
+
+  for (auto pending : deferred) delete pending;
+  deferred.clear();
 
   for (auto& xseg: x->outgoing.regular) xseg.postprocess();
-  for (auto& xseg : x->incoming.regular)
-  {
-    xseg.clear();
-    xseg.irecv_postprocess(x->blobs[xseg.jth]);
-  }
 
   if (mirroring)
     for (auto& vseg: v->own_segs) vseg.postprocess();
@@ -129,10 +210,29 @@ void VertexProgram<W, M, A, S>::execute_(uint32_t max_iters)
   final_wait_timer.stop();
 
   /* Sink Processing */
+  process_sinks<mirroring>(iter);
+
+  LOG.debug("Done with execute() \n");
+
+  /* Cleanup */
+  for (auto& xseg: x->outgoing.regular) xseg.postprocess();
+  for (auto& yseg: y->local_segs) yseg.postprocess();
+  for (auto& yseg: y->local_segs_sink) yseg.postprocess();
+  if (mirroring)
+    for (auto& vseg: v->own_segs) vseg.template postprocess<true>();
+}
+
+
+/** Scatter the messages of all (regular) vertices once more, to the sinks only. **/
+template <class W, class M, class A, class S>
+template <bool mirroring>
+void VertexProgram<W, M, A, S>::process_sinks(uint32_t iter)
+{
   DistTimer sink_timer("Sink Processing");
   LOG.debug("Executing Sink Processing \n");
 
   for (auto& xseg : x->incoming.regular) xseg.recv();
+  x->track();
 
   for (auto& vseg : v->own_segs)
   {
@@ -147,19 +247,9 @@ void VertexProgram<W, M, A, S>::execute_(uint32_t max_iters)
   process_messages<true, mirroring>(iter);
   produce_messages<true, false>(iter);
 
-  do { x->wait_for_some(); }
-  while (not x->no_more_segs_then_clear());
+  x->drain();
 
   sink_timer.stop();
-
-  LOG.debug("Done with execute() \n");
-
-  /* Cleanup */
-  for (auto& xseg: x->outgoing.regular) xseg.postprocess();
-  for (auto& yseg: y->local_segs) yseg.postprocess();
-  for (auto& yseg: y->local_segs_sink) yseg.postprocess();
-  if (mirroring)
-    for (auto& vseg: v->own_segs) vseg.template postprocess<true>();
 }
 
 
@@ -179,7 +269,7 @@ void VertexProgram<W, M, A, S>::execute_non_opt(uint32_t max_iters)
   } */
 
   /* Main Loop (Regular AND Sink Processing (non-optimizable)) */
-  uint32_t iter = 0;
+  uint32_t iter = first_iter;
   bool until_convergence = max_iters == UNTIL_CONVERGENCE;
   bool has_converged = false;
   MPI_Request convergence_req = MPI_REQUEST_NULL;
@@ -188,43 +278,53 @@ void VertexProgram<W, M, A, S>::execute_non_opt(uint32_t max_iters)
   {
     DistTimer it_timer("Iteration " + std::to_string(iter + 1));
     LOG.info("Executing Iteration %u\n", iter + 1);
+    stats.begin(iter);
 
     /* Request the current iteration's partial accumulators. */
     for (auto& yseg : y->own_segs) yseg.gather(); // Regular
     if (G->is_directed()) for (auto& yseg : y->own_segs_sink) yseg.gather();  // Sink
 
-    // if (mirroring and iter > 0)
-    // {
-    //   for (auto& vseg: v->own_segs) vseg.postprocess();  // Cleanup Regular
-    //   for (auto& vseg: v->own_segs) vseg.template postprocess<true>();  // Cleanup Sink
-    //   bcast_active_states_to_mirrors<false>();  // Regular
-    //   if (G->is_directed()) bcast_active_states_to_mirrors<true>();  // Sink
-    //   reset_activity();  // Vertex activity need only be maintained for mirroring.
-    // }
+    /* Refresh the mirrors of the states activated by the previous iteration (see execute_()). */
+    if (mirroring and iter > 0)
+    {
+      bcast_active_states_to_mirrors<false>();  // Regular
+      if (G->is_directed()) bcast_active_states_to_mirrors<true>();  // Sink
+      reset_activity();  // Vertex activity need only be maintained for mirroring.
+    }
+    stats.exchanged(IterationStat::MIRRORS_BYTES, IterationStat::MIRRORS_RECVD);
 
     process_messages<false, mirroring>(iter);  // Regular
     if (G->is_directed()) process_messages<true, mirroring>(iter);  // Sink
+    stats.exchanged(IterationStat::PROCESSING_BYTES, IterationStat::PROCESSING_RECVD);
 
     /* Request the next iteration's messages. */
     for (auto& xseg : x->incoming.regular) xseg.recv();
+    x->track();
+
+    if (checkpoint and checkpoint->due(iter + 1) and (until_convergence or iter + 1 < max_iters))
+      checkpoint->begin(iter + 1);
 
     has_converged = not produce_messages<false, false>(iter);  // Regular
     if (G->is_directed()) has_converged &= not produce_messages<true, false>(iter);  // Sink
+    stats.exchanged(IterationStat::PRODUCING_BYTES, IterationStat::PRODUCING_RECVD);
 
     if (until_convergence)
       has_converged = has_converged_globally(has_converged, convergence_req);
 
+    stats.end();
     it_timer.stop();
 
     iter++;
+
+    if (checkpoint)
+      checkpoint_iteration(until_convergence and has_converged);  // (Else, only local.)
   }
 
   /* Final Wait (Regular Processing) */
   DistTimer final_wait_timer("Final Wait");
   LOG.debug("Final Wait \n");
 
-  do { x->wait_for_some(); }
-  while (not x->no_more_segs_then_clear());
+  x->drain();
 
   final_wait_timer.stop();
 
@@ -232,12 +332,6 @@ void VertexProgram<W, M, A, S>::execute_non_opt(uint32_t max_iters)
 
   /* Cleanup */
   for (auto& xseg: x->outgoing.regular) xseg.postprocess();
-  for (auto& xseg : x->incoming.regular)
-  {
-    xseg.clear();
-    xseg.irecv_postprocess(x->blobs[xseg.jth]);
-  }
-  for (auto& xseg: x->outgoing.regular) xseg.postprocess();
   for (auto& yseg: y->local_segs) yseg.postprocess();
   if (G->is_directed()) for (auto& yseg: y->local_segs_sink) yseg.postprocess();
   if (mirroring)
@@ -267,6 +361,7 @@ void VertexProgram<W, M, A, S>::execute_single()
 
   DistTimer it_timer("Iteration 1");
   // LOG.info("Executing Iteration 1 \n");
+  stats.begin(0);
 
   /* Request the current iteration's partial accumulators. */
   for (auto& yseg : y->own_segs) yseg.gather();  // Regular
@@ -274,10 +369,13 @@ void VertexProgram<W, M, A, S>::execute_single()
 
   process_messages<false, mirroring>();  // Regular
   process_messages<true, mirroring>();  // Sink
+  stats.exchanged(IterationStat::PROCESSING_BYTES, IterationStat::PROCESSING_RECVD);
 
   produce_messages<false, true>();  // Regular single_iter
   produce_messages<true, true>();  // Sink single_iter
+  stats.exchanged(IterationStat::PRODUCING_BYTES, IterationStat::PRODUCING_RECVD);
 
+  stats.end();
   it_timer.stop();
 
   /* Final Wait */
@@ -317,14 +415,18 @@ void VertexProgram<W, M, A, S>::execute_single_undirected()
 
   DistTimer it_timer("Iteration 1");
   //LOG.debug("Executing Iteration 1 \n");
+  stats.begin(0);
 
   /* Request the current iteration's partial accumulators. */
   for (auto& yseg : y->own_segs) yseg.gather();  // Regular
 
   process_messages<false, mirroring>();  // Regular
+  stats.exchanged(IterationStat::PROCESSING_BYTES, IterationStat::PROCESSING_RECVD);
 
   produce_messages<false, true>();  // Regular single_iter
+  stats.exchanged(IterationStat::PRODUCING_BYTES, IterationStat::PRODUCING_RECVD);
 
+  stats.end();
   it_timer.stop();
 
   /* Final Wait */
@@ -349,21 +451,115 @@ template <class W, class M, class A, class S>
 bool VertexProgram<W, M, A, S>::has_converged_globally(
     bool has_converged_locally, MPI_Request& convergence_req)
 {
-  bool has_converged_globally = false;
-
   // First clear previous iteration's async request if any.
   if (convergence_req != MPI_REQUEST_NULL)
     MPI_Wait(&convergence_req, MPI_STATUS_IGNORE);
 
+  converged_locally = has_converged_locally;
+  converged_globally = false;
+
   // Async because we don't need to wait if we know we haven't converged locally.
-  MPI_Iallreduce(&has_converged_locally, &has_converged_globally, 1, MPI_CHAR,
+  MPI_Iallreduce(&converged_locally, &converged_globally, 1, MPI_C_BOOL,
                  MPI_LAND, Env::MPI_WORLD, &convergence_req);
 
   // Only wait if we've locally converged.
   if (has_converged_locally)
+  {
     MPI_Wait(&convergence_req, MPI_STATUS_IGNORE);
+    return converged_globally;
+  }
 
-  return has_converged_globally;
+  return false;
+}
+
+
+template <class W, class M, class A, class S>
+void VertexProgram<W, M, A, S>::bind()
+{
+  if (bound) return;
+  bound = true;
+
+  if (Env::node_nranks > 1)
+    window = new SharedWindow;
+
+  // Without persistent, only the channels between co-located ranks are bound.
+  const bool shared_only = not persistent;
+
+  set_vectors([&](auto& vec) { vec.bind(window, shared_only); });
+
+  // Only now that all slots are reserved.
+  if (window)
+    window->allocate();
+}
+
+
+template <class W, class M, class A, class S>
+void VertexProgram<W, M, A, S>::start_progress_thread()
+{
+  if (engine) return;
+
+  if (not Env::thread_multiple)
+  {
+    LOG.warn("No progress thread: MPI does not provide MPI_THREAD_MULTIPLE. \n");
+    return;
+  }
+
+  engine = new ProgressEngine;
+
+  set_vectors([&](auto& vec) { vec.set_engine(engine); });
+}
+
+
+template <class W, class M, class A, class S>
+void VertexProgram<W, M, A, S>::stop_progress_thread()
+{
+  if (not engine) return;
+
+  x->set_engine(nullptr);
+  y->set_engine(nullptr);
+
+  delete engine;
+  engine = nullptr;
+}
+
+
+template <class W, class M, class A, class S>
+void VertexProgram<W, M, A, S>::start_neighbor_exchanges()
+{
+  set_vectors([&](auto& vec)
+  {
+    NeighborExchange*& exchange = this->exchange_of(vec);
+    if (not exchange) exchange = new NeighborExchange;
+    vec.set_exchange(exchange);
+  });
+}
+
+
+template <class W, class M, class A, class S>
+void VertexProgram<W, M, A, S>::stop_neighbor_exchanges()
+{
+  x->set_exchange(nullptr);
+  y->set_exchange(nullptr);
+}
+
+
+template <class W, class M, class A, class S>
+void VertexProgram<W, M, A, S>::set_local_delivery(bool local)
+{
+  set_vectors([&](auto& vec) { vec.set_local(local); });
+}
+
+
+template <class W, class M, class A, class S>
+template <class Setter>
+void VertexProgram<W, M, A, S>::set_vectors(Setter set)
+{
+  // "IF" this is determined statically, the compiler should optimize these branches away.
+  if (not std::is_base_of<Serializable, M>::value)
+    set(*x);
+
+  if (not std::is_base_of<Serializable, A>::value)
+    set(*y);
 }
 
 
@@ -378,12 +574,170 @@ void VertexProgram<W, M, A, S>::scatter_source_messages()
   scatter_timer.stop();
 }
 
+template <class W, class M, class A, class S>
+bool VertexProgram<W, M, A, S>::advance_bucket()
+{
+  uint32_t next = UINT32_MAX;
+  uint32_t idx;
+
+  for (auto& vseg : v->own_segs)
+  {
+    auto& pending = *deferred[vseg.kth];
+    pending.rewind();
+    while (pending.next(idx))
+      next = std::min(next, priority(vseg[idx]) / delta);
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &next, 1, MPI_UINT32_T, MPI_MIN, Env::MPI_WORLD);
+
+  if (next == UINT32_MAX)
+    return false;
+
+  bucket = next;
+  LOG.debug("Advancing to Bucket %u \n", bucket);
+
+  // The last iteration's messages are all empty (it activated no vertex): replace them.
+  x->drain();
+
+  for (auto& xseg : x->incoming.regular) xseg.recv();
+  x->track();
+
+  for (auto& vseg : v->own_segs)
+  {
+    auto& pending = *deferred[vseg.kth];
+    auto& xseg = x->outgoing.regular[vseg.kth];
+
+    pending.rewind();
+    while (pending.next(idx))  // (Iterates over a copy of each word: safe to untouch.)
+    {
+      if (priority(vseg[idx]) / delta <= bucket)
+      {
+        pending.untouch(idx);
+        xseg.push(idx, scatter(vseg[idx]));
+      }
+    }
+
+    stats.add(IterationStat::SCATTERED, xseg.activity->count());
+    xseg.bcast();
+  }
+
+  x->flush();
+
+  return true;
+}
+
+
+template <class W, class M, class A, class S>
+void VertexProgram<W, M, A, S>::checkpoint_messages(MsgArray& xseg, uint32_t kth)
+{
+  if (not checkpoint or not checkpoint->started())
+    return;
+
+  uint32_t nbytes;
+  void* blob = xseg.serialize(nbytes);
+  checkpoint->add(checkpoint_key(kth, 2), blob, nbytes);
+}
+
+
+template <class W, class M, class A, class S>
+void VertexProgram<W, M, A, S>::checkpoint_iteration(bool has_converged)
+{
+  if (not checkpoint->started())
+    return;
+
+  if (has_converged)
+  {
+    checkpoint->abort();  // (Nothing left to resume.)
+    return;
+  }
+
+  DistTimer checkpoint_timer("Checkpointing");
+
+  uint32_t nbytes;
+  void* blob;
+
+  for (auto& vseg : v->own_segs)
+  {
+    // All the states (as an array of structs, whatever their layout; see SoAArray).
+    Communicable<RandomAccessArray<S>> states(vseg.size());
+    for (uint32_t idx = 0; idx < vseg.size(); idx++)
+      states.push(idx, vseg[idx]);
+
+    blob = states.serialize(nbytes);
+    checkpoint->add(checkpoint_key(vseg.kth, 0), blob, nbytes);
+
+    blob = vseg.activity->serialize(nbytes);
+    checkpoint->add(checkpoint_key(vseg.kth, 1), blob, nbytes);
+  }
+
+  checkpoint->commit();  // Written in the background.
+
+  checkpoint_timer.stop();
+}
+
+
+template <class W, class M, class A, class S>
+uint32_t VertexProgram<W, M, A, S>::resume(bool mirroring)
+{
+  uint32_t iter = checkpoint->latest();
+
+  if (iter == 0)
+  {
+    LOG.info("No checkpoint to resume from: starting over. \n");
+    return 0;
+  }
+
+  auto blobs = checkpoint->load(iter);
+
+  if (blobs.size() != 3 * v->own_segs.size())
+  {
+    LOG.error("The checkpoint of iteration %u is not of this vertex program. \n", iter);
+    Env::exit(1);
+  }
+
+  // Replace the initial messages in flight (see initialize()) by the checkpoint's.
+  x->drain();
+
+  for (auto& xseg : x->incoming.regular) xseg.recv();
+  x->track();
+
+  for (auto& vseg : v->own_segs)
+  {
+    auto& xseg = x->outgoing.regular[vseg.kth];
+    xseg.clear();
+    xseg.deserialize_from(blobs[checkpoint_key(vseg.kth, 2)].data());
+    xseg.bcast();
+
+    vseg.activity->clear();
+    vseg.deserialize_from(blobs[checkpoint_key(vseg.kth, 0)].data());  // (Activates them all.)
+  }
+
+  x->flush();
+
+  // Mirror all the states again, then restore their activity (i.e., of the last iteration).
+  if (mirroring)
+  {
+    bcast_active_states_to_mirrors<false>();  // Regular
+    if (G->is_directed()) bcast_active_states_to_mirrors<true>();  // Sink
+  }
+
+  for (auto& vseg : v->own_segs)
+  {
+    vseg.activity->clear();
+    vseg.activity->deserialize_from(blobs[checkpoint_key(vseg.kth, 1)].data());
+  }
+
+  LOG.info("Resuming from the checkpoint of iteration %u \n", iter);
+
+  return iter;
+}
+
+
 template <class W, class M, class A, class S>
 template <bool sink>
 void VertexProgram<W, M, A, S>::bcast_active_states_to_mirrors()
 {
-  auto& mir_vsegs = sink ? v->mir_segs_snk->segs : v->mir_segs_reg->segs;
-  for (auto& vseg : mir_vsegs) vseg.recv();
+  v->template recv_mirrors<sink>();
   for (auto& vseg : v->own_segs)
     vseg.template bcast<sink>();
 }
@@ -398,166 +752,147 @@ void VertexProgram<W, M, A, S>::process_messages(uint32_t iter)
   // Process xsegs as soon as they are ready (i.e., fully received). Note that there will
   // always be at least one xseg (the local one) ready at the start of every iteration.
 
-  std::vector<int>* ready;
-  do { ready = x->wait_for_some(); }
-  while (not process_ready_messages<sink, mirroring>(*ready, iter));
+  // Every ready jth xseg adds a task per row band of every local yseg (i.e., per band of every
+  // tile of its col-group). Tasks of the same band run in turn, the others concurrently, while
+  // the next xsegs are received.
+
+  reset_scheduler<sink>();
+
+  auto feed = [&]()
+  {
+    for (auto jth : *x->wait_for_some())
+      schedule_jth_tiles<sink, mirroring>(jth, iter);
+
+    return not x->no_more_segs();
+  };
+
+  #pragma omp parallel
+  scheduler.run(feed);
+
+  x->no_more_segs_then_clear();
 
   process_timer.stop();
 }
 
 
-/** Receive xseg along the jth col-group. **/
 template <class W, class M, class A, class S>
-template <bool source>
-StreamingArray<M>& VertexProgram<W, M, A, S>::receive_jth_xseg(uint32_t jth)
+template <bool sink>
+void VertexProgram<W, M, A, S>::reset_scheduler()
 {
-  assert(jth < x->incoming.regular.size());
-  auto& xseg = source ? x->incoming.source[jth] : x->incoming.regular[jth];
-
-  // Receive messages from regular vertices.
-  // (There should be at least one xseg blob that is ready (fully recvd))
+  auto& ysegs = sink ? y->local_segs_sink : y->local_segs;
 
-  if (not source and not x->blobs.empty())
-  {
-    xseg.clear();
-    x->irecv_postprocess(jth);
-  }
+  lanes.assign(ysegs.size() + 1, 0);
+  for (uint32_t i = 0; i < ysegs.size(); i++)
+    lanes[i + 1] = lanes[i] + ysegs[i].nbands;
 
-  return xseg;
+  scheduler.reset(lanes.back());
 }
 
 
-/**
- * Returns true iff done processing all messages for the current iteration. 
- **/
 template <class W, class M, class A, class S>
 template <bool sink, bool mirroring>
-bool VertexProgram<W, M, A, S>::process_ready_messages(
-    const std::vector<int32_t>& ready, uint32_t iter)
+void VertexProgram<W, M, A, S>::schedule_jth_tiles(uint32_t jth, uint32_t iter)
 {
-  if (gather_depends_on_state)
-    return process_ready_messages_with_states<sink, mirroring>(ready, iter);
-
-  //LOG.trace("Processing %u Ready Messages \n", ready.size());
-
   auto& ysegs = sink ? y->local_segs_sink : y->local_segs;
 
-  // For each ready jth xseg, compute all jth-column tiles (in parallel).
+  StreamingArray<M>& xseg = receive_jth_xseg<false>(jth);  // Regular messages
+  StreamingArray<M>& xseg_ = receive_jth_xseg<true>(jth);  // Source messages
 
-  for (auto jth : ready)
-  {
-    StreamingArray<M>& xseg = receive_jth_xseg<false>(jth);  // Regular messages
-    StreamingArray<M>& xseg_ = receive_jth_xseg<true>(jth);  // Source messages
+  // (Sets their sentinels, ahead of the tiles' concurrent cursors.)
+  xseg.rewind();
+  xseg_.rewind();
 
-    auto& colgrp = G->get_matrix()->local_colgrps[jth];
+  bool with_sources = sink or stationary or iter == 0;
+  uint64_t nmsgs = xseg.activity->count() + (with_sources ? xseg_.activity->count() : 0);
 
-    #pragma omp parallel for schedule(dynamic)
-    for (auto i = 0; i < ysegs.size(); i++)
-    {
-      // Concurrent readers (shallow copy).
-      StreamingArray<M> xseg_cr_(xseg_);
-      StreamingArray<M> xseg_cr(xseg);
+  auto& colgrp = G->get_matrix()->local_colgrps[jth];
 
-      auto& yseg = ysegs[i];
+  for (uint32_t i = 0; i < ysegs.size(); i++)
+  {
+    // Weight: the band's nnz (about), scaled by the fraction of its columns with messages.
+    auto& tile = *colgrp.local_tiles[ysegs[i].ith];
+    auto& csc = sink ? *tile.sink_csc : *tile.csc;
+    uint64_t weight = csc.nentries / csc.nbands * (nmsgs + 1) / (xseg.size() + xseg_.size() + 1);
 
-      VertexMirrorSegment<Matrix, VertexArray>* vseg = nullptr;
+    csc.prefetch();  // (Out of core: read the tile in while it waits for its turn.)
 
-      // Sink processing
-      if (sink)
-      {
-        // Source messages -> Sink vertices
-        SpMV<false>(*colgrp.local_tiles[yseg.ith]->sink_csc, xseg_cr_, yseg, vseg, xseg.size());
-        // Regular messages -> Sink vertices
-        SpMV<false>(*colgrp.local_tiles[yseg.ith]->sink_csc, xseg_cr, yseg, vseg, 0);
-      }
+    for (uint32_t b = 0; b < csc.nbands; b++)
+      scheduler.add(lanes[i] + b, weight,
+                    [=]() { process_tile<sink, mirroring>(jth, i, b, iter); });
+  }
+}
 
-      // Regular processing
-      else
-      {
-        // Source messages -> Regular vertices
-        // If stationary app, do this every iteration. If non-stationary, only in the first one.
-        if (stationary or iter == 0)
-          SpMV<false>(*colgrp.local_tiles[yseg.ith]->csc, xseg_cr_, yseg, vseg, xseg.size());
-        // Regular messages -> Regular vertices
-        SpMV<false>(*colgrp.local_tiles[yseg.ith]->csc, xseg_cr, yseg, vseg, 0);
-      }
 
-      yseg.ncombined++;
+/** Receive xseg along the jth col-group. **/
+template <class W, class M, class A, class S>
+template <bool source>
+StreamingArray<M>& VertexProgram<W, M, A, S>::receive_jth_xseg(uint32_t jth)
+{
+  assert(jth < x->incoming.regular.size());
+  auto& xseg = source ? x->incoming.source[jth] : x->incoming.regular[jth];
 
-      if (x->no_more_segs() && yseg.ready()) yseg.send();
-    }
-  }
+  // Receive messages from regular vertices.
+  // (There should be at least one xseg blob that is ready (fully recvd))
+
+  if (not source and not x->blobs.empty())
+    x->irecv_postprocess(jth);  // Clears xseg first (unless already done by the engine).
 
-  return x->no_more_segs_then_clear();
+  return xseg;
 }
 
 
 /**
- * Returns true iff done processing all messages for the current iteration.
+ * Process a row band of the tile of the ith local yseg along the jth col-group (with source
+ * messages, if any, and mirrored vertex states, if gather depends on them). Sends the yseg once
+ * complete, i.e., once every band of each of its tiles is.
  **/
 template <class W, class M, class A, class S>
 template <bool sink, bool mirroring>
-bool VertexProgram<W, M, A, S>::process_ready_messages_with_states(
-    const std::vector<int32_t>& ready, uint32_t iter)
+void VertexProgram<W, M, A, S>::process_tile(uint32_t jth, uint32_t i, uint32_t band,
+                                             uint32_t iter)
 {
-  //LOG.trace("Processing %u Ready Messages \n", ready.size());
+  TraceSpan span("SpMV");
 
   auto& ysegs = sink ? y->local_segs_sink : y->local_segs;
+  auto& yseg = ysegs[i];
 
-  // For each ready jth xseg, compute all jth-column tiles (in parallel).
+  auto& colgrp = G->get_matrix()->local_colgrps[jth];
+  auto& csc = sink ? *colgrp.local_tiles[yseg.ith]->sink_csc : *colgrp.local_tiles[yseg.ith]->csc;
 
-  for (auto jth : ready)
-  {
-    StreamingArray<M>& xseg = receive_jth_xseg<false>(jth);  // Regular messages
-    StreamingArray<M>& xseg_ = receive_jth_xseg<true>(jth);  // Source messages
+  auto& xseg = x->incoming.regular[jth];  // Regular messages
+  auto& xseg_ = x->incoming.source[jth];  // Source messages
 
-    auto& colgrp = G->get_matrix()->local_colgrps[jth];
+  uint32_t nregular = xseg.size();
 
-    #pragma omp parallel for schedule(dynamic)
-    for (auto i = 0; i < ysegs.size(); i++)
-    {
-      // Concurrent readers (shallow copy).
-      StreamingArray<M> xseg_cr_(xseg_);
-      StreamingArray<M> xseg_cr(xseg);
-
-      auto& yseg = ysegs[i];
-
-      VertexMirrorSegment<Matrix, VertexArray>* vseg
-          = sink ? &(v->mir_segs_snk->segs[yseg.ith]) : &(v->mir_segs_reg->segs[yseg.ith]);
-
-      if (mirroring)
-      {
-        LOG.debug("Waiting for mirrors (sink=%u) ... \n", sink);
-        v->template wait_for_ith<sink>(yseg.ith);
-      }
-
-      // Sink processing
-      if (sink)
-      {
-        // Source messages -> Sink vertices
-        SpMV<true>(*colgrp.local_tiles[yseg.ith]->sink_csc, xseg_cr_, yseg, vseg, xseg.size());
-        // Regular messages -> Sink vertices
-        SpMV<true>(*colgrp.local_tiles[yseg.ith]->sink_csc, xseg_cr, yseg, vseg, 0);
-      }
-
-      // Regular processing
-      else
-      {
-        // Source messages -> Regular vertices
-        // If stationary app, do this every iteration. If non-stationary, only in the first one.
-        if (stationary or iter == 0)
-          SpMV<true>(*colgrp.local_tiles[yseg.ith]->csc, xseg_cr_, yseg, vseg, xseg.size());
-        // Regular messages -> Regular vertices
-        SpMV<true>(*colgrp.local_tiles[yseg.ith]->csc, xseg_cr, yseg, vseg, 0);
-      }
+  // Sink processing: Source and Regular messages -> Sink vertices.
+  // Regular processing: the same, but -> Regular vertices. If stationary app, process source
+  // messages every iteration. If non-stationary, only in the first one.
+  bool with_sources = sink or stationary or iter == 0;
 
-      yseg.ncombined++;
+  if (gather_depends_on_state)
+  {
+    VertexMirrorSegment<Matrix, VertexArray>* vseg
+        = sink ? &(v->mir_segs_snk->segs[yseg.ith]) : &(v->mir_segs_reg->segs[yseg.ith]);
 
-      if (x->no_more_segs() && yseg.ready()) yseg.send();
+    if (mirroring)
+    {
+      LOG.debug("Waiting for mirrors (sink=%u) ... \n", sink);
+      std::lock_guard<std::mutex> lock(mirrors_mutex);  // (Other bands may wait for the same.)
+      v->template wait_for_ith<sink>(yseg.ith);
     }
+
+    if (with_sources)
+      SpMV<true>(csc, xseg_.cursor(), yseg, vseg, nregular, band);
+    SpMV<true>(csc, xseg.cursor(), yseg, vseg, 0, band);
+  }
+  else
+  {
+    if (with_sources)
+      SpMV<false>(csc, xseg_.cursor(), yseg, nullptr, nregular, band);
+    SpMV<false>(csc, xseg.cursor(), yseg, nullptr, 0, band);
   }
 
-  return x->no_more_segs_then_clear();
+  if (yseg.combined()) yseg.send();
 }
 
 
@@ -565,21 +900,28 @@ template <class W, class M, class A, class S>
 template <bool gather_with_state>
 void VertexProgram<W, M, A, S>::SpMV(
     const CSC<W>& csc,           /** A_ith_jth **/
-    StreamingArray<M>& xseg,     /** x_jth **/
+    MsgCursor xseg,              /** x_jth **/
     RandomAccessArray<A>& yseg,  /** y_ith **/
-    RandomAccessArray<S>* vseg,  /** v_ith **/
-    uint32_t sink_offset         /** sink_offset in CSC **/)
+    StateArray* vseg,            /** v_ith **/
+    uint32_t sink_offset,        /** sink_offset in CSC **/
+    uint32_t band                /** row band of the CSC **/)
 {
   uint32_t i;
   M msg;
 
-  xseg.rewind();
+  // Other bands of yseg may be processed at once: they touch disjoint words of its activity,
+  // but share its count.
+  const uint32_t* begins = csc.bandptrs[band] + sink_offset;
+  const uint32_t* ends = csc.bandptrs[band + 1] + sink_offset;
+  uint32_t ntouched = 0;
+  uint64_t nedges = 0;
 
   while (xseg.next(i, msg))
   {
     assert(i < xseg.size());
+    nedges += ends[i] - begins[i];
 
-    for (uint32_t j = csc.colptrs[sink_offset + i]; j < csc.colptrs[sink_offset + i + 1]; j++)
+    for (uint32_t j = begins[i]; j < ends[i]; j++)
     {
       assert(j < csc.nentries);
 
@@ -593,12 +935,15 @@ void VertexProgram<W, M, A, S>::SpMV(
         combine(gather(Edge<W>(csc.colidxs[sink_offset + i], entry.idx, entry.edge_ptr()), msg),
                 yseg[entry.global_idx]);
 
-      yseg.activity->touch(entry.global_idx);
+      ntouched += yseg.activity->touch_uncounted(entry.global_idx);
 
       //LOG.trace<false>("Processing Column %u, Row %u, Output %u\n", i, entry.idx, yseg[entry.idx]);
     }
   }
 
+  yseg.activity->add_count(ntouched);
+  stats.add(IterationStat::EDGES, nedges);
+
   // LOG.info<false>("SpMV done \n");
 }
 
@@ -620,16 +965,7 @@ bool VertexProgram<W, M, A, S>::produce_messages(uint32_t iter)
 
     for (auto& final_yseg : sink ? y->own_segs_sink : y->own_segs)
     {
-      auto ready = final_yseg.wait_for_some();
-
-      for (auto jth : ready)
-      {
-        auto& partial = (*(final_yseg.partials))[jth];
-
-        final_yseg.irecv_postprocess(jth);
-
-        combine_accumulators(partial, final_yseg);
-      }
+      combine_accumulators(final_yseg.wait_for_some(), final_yseg);
 
       if (final_yseg.no_more_segs())
       {
@@ -651,18 +987,67 @@ bool VertexProgram<W, M, A, S>::produce_messages(uint32_t iter)
 
 template <class W, class M, class A, class S>
 void VertexProgram<W, M, A, S>::combine_accumulators(
-    AccumArray& partial_yseg, AccumFinalSegment<Matrix, AccumArray>& final_yseg)
+    uint32_t jth, AccumFinalSegment<Matrix, AccumArray>& final_yseg)
 {
-  partial_yseg.rewind();
+  final_yseg.take(jth, [&](const BitVector& activity, auto values)
+  {
+    uint32_t nchunks = num_chunks(activity, activity.count());
+    stats.add(IterationStat::COMBINED, activity.count());
 
-  uint32_t idx;
-  A yval;
+    if (nchunks == 0)
+    {
+      uint32_t x = 0;
+      activity.for_each(0, activity.get_nwords(), [&](uint32_t idx)
+      {
+        combine(values(idx, x++), final_yseg[idx]);
+      });
+    }
+    else
+    {
+      // The values of a chunk follow those of the chunks before it.
+      std::vector<uint32_t> offsets(nchunks + 1, 0);
 
-  while (partial_yseg.pop(idx, yval))
-  {
-    combine(yval, final_yseg[idx]);
-    final_yseg.activity->touch(idx);
-  }
+      #pragma omp parallel for schedule(static)
+      for (uint32_t c = 0; c < nchunks; c++)
+        offsets[c + 1] = activity.count(c * CHUNK_NWORDS, (c + 1) * CHUNK_NWORDS);
+
+      std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+      // Each thread owns a chunk of the final accumulators.
+      #pragma omp parallel for schedule(dynamic)
+      for (uint32_t c = 0; c < nchunks; c++)
+      {
+        uint32_t x = offsets[c];
+        activity.for_each(c * CHUNK_NWORDS, (c + 1) * CHUNK_NWORDS, [&](uint32_t idx)
+        {
+          combine(values(idx, x++), final_yseg[idx]);
+        });
+      }
+    }
+
+    final_yseg.activity->union_with(activity);
+  });
+}
+
+
+template <class W, class M, class A, class S>
+void VertexProgram<W, M, A, S>::combine_accumulators(
+    const std::vector<int32_t>& ready, AccumFinalSegment<Matrix, AccumArray>& final_yseg)
+{
+  // One at a time (i.e., in the same order per vertex as serially), each in parallel.
+  for (auto jth : ready)
+    combine_accumulators(jth, final_yseg);
+}
+
+
+template <class W, class M, class A, class S>
+uint32_t VertexProgram<W, M, A, S>::num_chunks(const BitVector& activity, uint32_t count) const
+{
+  if (count < PARALLEL_MIN_COUNT or omp_get_max_threads() == 1)
+    return 0;
+
+  uint32_t nchunks = (activity.get_nwords() + CHUNK_NWORDS - 1) / CHUNK_NWORDS;
+  return nchunks > 1 ? nchunks : 0;
 }
 
 
@@ -672,6 +1057,7 @@ bool VertexProgram<W, M, A, S>::apply_and_scatter_messages(
     AccumFinalSegment<Matrix, AccumArray>& final_yseg, uint32_t iter)
 {
   bool any_activated = false;
+  uint32_t nactivated = 0;
 
   auto& vseg = v->own_segs[final_yseg.kth];
 
@@ -693,10 +1079,22 @@ bool VertexProgram<W, M, A, S>::apply_and_scatter_messages(
       bool got_activated = apply_with_iter ? apply(yval, vseg[sink_offset + idx], iter)
                                            : apply(yval, vseg[sink_offset + idx]);
       if (got_activated)
+      {
         vseg.activity->push(sink_offset + idx);
+        nactivated++;
+      }
     }
   }
 
+  else if (not single_iter and num_chunks(*final_yseg.activity, final_yseg.activity->count()))
+  {
+    nactivated = apply_and_scatter_chunks<apply_with_iter>(final_yseg, iter);
+    any_activated = nactivated > 0;
+    checkpoint_messages(xseg, final_yseg.kth);
+    stats.add(IterationStat::SCATTERED, xseg.activity->count());
+    xseg.bcast();
+  }
+
   else
   {
     uint32_t idx;
@@ -706,7 +1104,21 @@ bool VertexProgram<W, M, A, S>::apply_and_scatter_messages(
     {
       bool got_activated = apply_with_iter ? apply(yval, vseg[idx], iter)
                                            : apply(yval, vseg[idx]);
+
+      // Delta-stepping: vertices beyond the current bucket scatter once it is reached.
+      if (got_activated and bucketing() and not single_iter)
+      {
+        auto& pending = *deferred[final_yseg.kth];
+        if (priority(vseg[idx]) / delta > bucket)
+        {
+          pending.push(idx);
+          continue;
+        }
+        pending.untouch(idx);
+      }
+
       any_activated |= got_activated;
+      nactivated += got_activated;
 
       if (got_activated or stationary)
       {
@@ -717,11 +1129,92 @@ bool VertexProgram<W, M, A, S>::apply_and_scatter_messages(
     }
 
     if (not single_iter)
+    {
+      checkpoint_messages(xseg, final_yseg.kth);
+      stats.add(IterationStat::SCATTERED, xseg.activity->count());
       xseg.bcast();
+    }
   }
 
+  stats.add(IterationStat::ACTIVATED, nactivated);
+
   return any_activated;
 }
 
 
+template <class W, class M, class A, class S>
+template <bool apply_with_iter>
+uint32_t VertexProgram<W, M, A, S>::apply_and_scatter_chunks(
+    AccumFinalSegment<Matrix, AccumArray>& final_yseg, uint32_t iter)
+{
+  auto& vseg = v->own_segs[final_yseg.kth];
+
+  auto& xseg = x->outgoing.regular[final_yseg.kth];
+
+  auto& activity = *final_yseg.activity;
+
+  uint32_t nchunks = num_chunks(activity, activity.count());
+  if (chunks.size() < nchunks)
+    chunks.resize(nchunks);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (uint32_t c = 0; c < nchunks; c++)
+  {
+    auto& chunk = chunks[c];
+    chunk.messages.clear();
+    chunk.deferred.clear();
+    chunk.nactivated = 0;
+
+    activity.for_each(c * CHUNK_NWORDS, (c + 1) * CHUNK_NWORDS, [&](uint32_t idx)
+    {
+      A yval = final_yseg[idx];
+      final_yseg[idx] = A();
+
+      bool got_activated = apply_with_iter ? apply(yval, vseg[idx], iter)
+                                           : apply(yval, vseg[idx]);
+
+      // Delta-stepping: vertices beyond the current bucket scatter once it is reached.
+      if (got_activated and bucketing() and priority(vseg[idx]) / delta > bucket)
+      {
+        chunk.deferred.push_back(idx);
+        return;
+      }
+
+      chunk.nactivated += got_activated;
+
+      if (got_activated or stationary)
+        chunk.messages.push_back({idx, got_activated, scatter(vseg[idx])});
+    });
+  }
+
+  activity.clear();
+
+  // Only the bitvectors (which keep shared counts) and the xseg are left to the merge.
+  uint32_t nactivated = 0;
+
+  for (uint32_t c = 0; c < nchunks; c++)
+  {
+    auto& chunk = chunks[c];
+    nactivated += chunk.nactivated;
+
+    if (bucketing())
+    {
+      auto& pending = *deferred[final_yseg.kth];
+      for (auto idx : chunk.deferred)
+        pending.push(idx);
+      for (auto& message : chunk.messages)
+        if (message.activated) pending.untouch(message.idx);
+    }
+
+    for (auto& message : chunk.messages)
+    {
+      vseg.activity->push(message.idx);
+      xseg.push(message.idx, message.msg);
+    }
+  }
+
+  return nactivated;
+}
+
+
 #endif
@@ -0,0 +1,142 @@
+/*
+ * Vertex program implementation - pipelined iterations (see ExecutionMode::PIPELINED).
+ */
+
+#ifndef VERTEX_PROGRAM_PIPELINED_HPP
+#define VERTEX_PROGRAM_PIPELINED_HPP
+
+//#include "vprogram/vertex_program.h"
+
+
+template <class W, class M, class A, class S>
+bool VertexProgram<W, M, A, S>::pipelined() const
+{
+  if (mode != ExecutionMode::PIPELINED)
+    return false;
+
+  bool valid = optimizable and delta == 0
+               and not std::is_base_of<Serializable, M>::value
+               and not std::is_base_of<Serializable, A>::value;
+
+  if (not valid)
+    LOG.warn("Pipelined mode does not apply to this vertex program: executing BSP. \n");
+
+  return valid;
+}
+
+
+/**
+ * Iterations still follow one another, but without a barrier in between: while some owned
+ * segments wait for partial accumulators, those already complete are applied, and the messages
+ * of the next iteration they bcast are processed by any rank as soon as they arrive.
+ *
+ * Segments never mix iterations: each xseg (or partial) is recv'd into the next iteration only
+ * once the current one consumed it, and, being sent again only after that, the next one cannot
+ * overtake it (MPI's non-overtaking order, per sender and tag).
+ **/
+template <class W, class M, class A, class S>
+template <bool mirroring>
+bool VertexProgram<W, M, A, S>::produce_and_process_messages(uint32_t iter)
+{
+  DistTimer pipeline_timer("Pipelined Processing");
+
+  auto& final_ysegs = y->own_segs;
+
+  std::vector<bool> applied(final_ysegs.size(), false);
+  uint32_t napplied = 0;
+
+  bool any_activated = false;
+
+  // Combine the kth final yseg's ready partials. Once it has them all, apply it (bcast'ing the
+  // next iteration's messages) and gather its partials of the next iteration.
+  auto combine_and_apply = [&](uint32_t k, const std::vector<int32_t>& ready)
+  {
+    auto& final_yseg = final_ysegs[k];
+
+    combine_accumulators(ready, final_yseg);
+
+    if (final_yseg.no_more_segs())
+    {
+      if (apply_depends_on_iter)
+        any_activated |= apply_and_scatter_messages<false, true, false>(final_yseg, iter);
+      else
+        any_activated |= apply_and_scatter_messages<false, false, false>(final_yseg, iter);
+
+      final_yseg.gather();
+      applied[k] = true;
+      napplied++;
+    }
+  };
+
+  // Apply first (the other ranks' next iteration waits on it), then schedule the next messages
+  // that arrived. If neither progresses and it may block, wait for a partial (all of which are
+  // sent already) or, once all are applied, for the next messages.
+  auto progress = [&](bool block)
+  {
+    bool progressed = false;
+
+    for (uint32_t k = 0; k < final_ysegs.size(); k++)
+    {
+      if (applied[k])
+        continue;
+
+      auto& ready = final_ysegs[k].test_for_some();
+      if (not ready.empty())
+      {
+        combine_and_apply(k, ready);
+        progressed = true;
+      }
+    }
+
+    if (not x->no_more_segs())
+    {
+      for (auto jth : *x->test_for_some())
+      {
+        schedule_jth_tiles<false, mirroring>(jth, iter + 1);
+        progressed = true;
+      }
+    }
+
+    if (block and not progressed)
+    {
+      if (napplied < final_ysegs.size())
+      {
+        uint32_t k = std::find(applied.begin(), applied.end(), false) - applied.begin();
+        combine_and_apply(k, final_ysegs[k].wait_for_some());
+      }
+      else if (not x->no_more_segs())
+      {
+        for (auto jth : *x->wait_for_some())
+          schedule_jth_tiles<false, mirroring>(jth, iter + 1);
+      }
+    }
+
+    return napplied < final_ysegs.size() or not x->no_more_segs();
+  };
+
+  reset_scheduler<false>();
+
+  #pragma omp parallel
+  scheduler.run([&]() { return progress(true); }, [&]() { progress(false); });
+
+  x->no_more_segs_then_clear();
+
+  pipeline_timer.stop();
+
+  return any_activated;
+}
+
+
+template <class W, class M, class A, class S>
+void VertexProgram<W, M, A, S>::drop_partial_accumulators()
+{
+  for (auto& final_yseg : y->own_segs)
+  {
+    while (not final_yseg.no_more_segs())
+      for (auto jth : final_yseg.wait_for_some())
+        final_yseg.take(jth, [](const BitVector&, auto) {});  // (Dropped.)
+  }
+}
+
+
+#endif